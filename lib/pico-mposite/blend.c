@@ -0,0 +1,267 @@
+//
+// Title:	        Pico-mposite Blending
+// Description:		Lookup table blend modes
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Each channel has a table of the result for every pair of screen and source levels, 8x8 for red
+// and green and 4x4 for blue on the colour board, or 16x16 on the mono board, built for the mode
+// and alpha being drawn with. A fill has a single source colour, so those collapse further into one
+// 256 byte table from screen pixel to result, and spans are then done a word (four pixels) at a
+// time with four lookups, much as an opaque fill writes them. Both tables are kept between calls,
+// so drawing many shapes with the same colour and mode only builds them once
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "blend.h"
+
+#if opt_colour
+#define BLEND_CHANNELS 3
+static const uint8_t blend_levels[BLEND_CHANNELS] = {8, 8, 4}; // Red, green and blue, as packed by rgb()
+#else
+#define BLEND_CHANNELS 1
+static const uint8_t blend_levels[BLEND_CHANNELS] = {16};
+#endif
+
+uint8_t blend_channel[BLEND_CHANNELS][256]; // Result for each screen level * levels + source level
+uint8_t blend_lut[256];                     // Result for each screen pixel, for blend_colour
+int blend_mode = -1;                        // The mode and alpha blend_channel is for
+int blend_alpha;
+int blend_colour = -1;                      // The source colour blend_lut is for, or -1
+
+// Build the channel tables for a mode
+//
+static void blend_prepare(int mode, int alpha)
+{
+    alpha = alpha < 0 ? 0 : alpha > BLEND_OPAQUE ? BLEND_OPAQUE : alpha;
+    if (mode == blend_mode && alpha == blend_alpha)
+    {
+        return;
+    }
+    for (int c = 0; c < BLEND_CHANNELS; c++)
+    {
+        int n = blend_levels[c];
+        int max = n - 1;
+        for (int d = 0; d < n; d++)
+        {
+            for (int s = 0; s < n; s++)
+            {
+                int v;
+                switch (mode)
+                {
+                case BLEND_ADD:
+                    v = d + s > max ? max : d + s;
+                    break;
+                case BLEND_MULTIPLY:
+                    v = (d * s + max / 2) / max;
+                    break;
+                case BLEND_MAX:
+                    v = d > s ? d : s;
+                    break;
+                default:
+                    v = s;
+                    break;
+                }
+                blend_channel[c][d * n + s] = d + ((v - d) * alpha + (v < d ? -8 : 8)) / BLEND_OPAQUE;
+            }
+        }
+    }
+    blend_mode = mode;
+    blend_alpha = alpha;
+    blend_colour = -1;
+}
+
+// Blend a source pixel over a screen pixel with the channel tables
+//
+static inline uint8_t blend_pixel(uint8_t d, uint8_t s)
+{
+#if opt_colour
+    return blend_channel[0][(d & 7) << 3 | (s & 7)] | blend_channel[1][(d & 0x38) | (s >> 3 & 7)] << 3 | blend_channel[2][(d >> 6) << 2 | s >> 6] << 6;
+#else
+    return colour_base + blend_channel[0][((d - colour_base) & 15) << 4 | ((s - colour_base) & 15)];
+#endif
+}
+
+// Build the table for a fill colour
+//
+static void blend_fill(unsigned char colour, int mode, int alpha)
+{
+    blend_prepare(mode, alpha);
+    if (blend_colour != colour)
+    {
+        for (int d = 0; d < 256; d++)
+        {
+            blend_lut[d] = blend_pixel(d, colour_base + colour);
+        }
+        blend_colour = colour;
+    }
+}
+
+// Blend a run of screen pixels with blend_lut, a word at a time once aligned
+//
+static void blend_span(unsigned char *p, int n)
+{
+    for (; n > 0 && ((uintptr_t)p & 3); n--, p++)
+    {
+        *p = blend_lut[*p];
+    }
+    uint32_t *w = (uint32_t *)p;
+    for (; n >= 4; n -= 4, w++)
+    {
+        uint32_t v = *w;
+        *w = blend_lut[v & 0xff] | blend_lut[v >> 8 & 0xff] << 8 | blend_lut[v >> 16 & 0xff] << 16 | (uint32_t)blend_lut[v >> 24] << 24;
+    }
+    for (p = (unsigned char *)w; n > 0; n--, p++)
+    {
+        *p = blend_lut[*p];
+    }
+}
+
+// Draw a blended horizontal line
+// - x: X position of the left end
+// - y: Y position
+// - w: Width in pixels
+// - colour: Colour
+// - mode: BLEND_ALPHA, BLEND_ADD, BLEND_MULTIPLY or BLEND_MAX
+// - alpha: Strength, 0 to BLEND_OPAQUE
+//
+void drawHLineBlend(short x, short y, short w, unsigned char colour, int mode, int alpha)
+{
+    if (y < 0 || y >= screenHeight)
+        return;
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (x + w > screenWidth)
+        w = screenWidth - x;
+    if (w <= 0)
+        return;
+    blend_fill(colour, mode, alpha);
+    blend_span(&screen_bitmap_next[y * screenWidth + x], w);
+}
+
+// Draw a blended filled rectangle
+// - x: X position of the top left corner
+// - y: Y position of the top left corner
+// - w: Width in pixels
+// - h: Height in pixels
+// - colour: Colour
+// - mode: BLEND_ALPHA, BLEND_ADD, BLEND_MULTIPLY or BLEND_MAX
+// - alpha: Strength, 0 to BLEND_OPAQUE
+//
+void fillRectBlend(short x, short y, short w, short h, unsigned char colour, int mode, int alpha)
+{
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if (x + w > screenWidth)
+        w = screenWidth - x;
+    if (y + h > screenHeight)
+        h = screenHeight - y;
+    if (w <= 0 || h <= 0)
+        return;
+    blend_fill(colour, mode, alpha);
+    for (int j = 0; j < h; j++)
+    {
+        blend_span(&screen_bitmap_next[(y + j) * screenWidth + x], w);
+    }
+}
+
+// Draw a blended filled triangle, with the same edges as fillTriangle
+// - x0, y0, x1, y1, x2, y2: The corners
+// - colour: Colour
+// - mode: BLEND_ALPHA, BLEND_ADD, BLEND_MULTIPLY or BLEND_MAX
+// - alpha: Strength, 0 to BLEND_OPAQUE
+//
+void fillTriangleBlend(short x0, short y0, short x1, short y1, short x2, short y2, unsigned char colour, int mode, int alpha)
+{
+    if (y0 > y1)
+    {
+        swapNumb(&y0, &y1);
+        swapNumb(&x0, &x1);
+    }
+    if (y1 > y2)
+    {
+        swapNumb(&y1, &y2);
+        swapNumb(&x1, &x2);
+    }
+    if (y0 > y1)
+    {
+        swapNumb(&y0, &y1);
+        swapNumb(&x0, &x1);
+    }
+    blend_fill(colour, mode, alpha);
+    int ys = y0 < 0 ? 0 : y0;
+    int ye = y2 > screenHeight ? screenHeight : y2;
+    for (int y = ys; y < ye; y++)
+    {
+        int a = x0 + (x2 - x0) * (y - y0) / (y2 - y0); // The long edge
+        int b = y < y1 ? x0 + (x1 - x0) * (y - y0) / (y1 - y0) : x1 + (x2 - x1) * (y - y1) / (y2 - y1);
+        if (a > b)
+        {
+            int t = a;
+            a = b;
+            b = t;
+        }
+        if (a < 0)
+            a = 0;
+        if (b > screenWidth)
+            b = screenWidth;
+        if (a < b)
+        {
+            blend_span(&screen_bitmap_next[y * screenWidth + a], b - a);
+        }
+    }
+}
+
+// Blend a row of pixels over another, such as a row of an image over a row of the screen
+// - dst: The pixels blended onto
+// - src: The pixels to blend, as they would be drawn, colour_base included
+// - n: Number of pixels
+// - mode: BLEND_ALPHA, BLEND_ADD, BLEND_MULTIPLY or BLEND_MAX
+// - alpha: Strength, 0 to BLEND_OPAQUE
+//
+void blend_row(unsigned char *dst, const unsigned char *src, int n, int mode, int alpha)
+{
+    blend_prepare(mode, alpha);
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 3) == 0) // Same alignment; a word of each at a time
+    {
+        for (; n > 0 && ((uintptr_t)dst & 3); n--)
+        {
+            *dst = blend_pixel(*dst, *src++);
+            dst++;
+        }
+        uint32_t *dw = (uint32_t *)dst;
+        const uint32_t *sw = (const uint32_t *)src;
+        for (; n >= 4; n -= 4)
+        {
+            uint32_t d = *dw, s = *sw++;
+            *dw++ = blend_pixel(d, s) | blend_pixel(d >> 8, s >> 8) << 8 | blend_pixel(d >> 16, s >> 16) << 16 | (uint32_t)blend_pixel(d >> 24, s >> 24) << 24;
+        }
+        dst = (unsigned char *)dw;
+        src = (const unsigned char *)sw;
+    }
+    for (; n > 0; n--)
+    {
+        *dst = blend_pixel(*dst, *src++);
+        dst++;
+    }
+}
@@ -0,0 +1,35 @@
+//
+// Title:	        Pico-mposite Blending
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Blended fills and rows: alpha, additive, multiply and max, worked out a colour channel at a
+// time through lookup tables, instead of the dithered transparency of the other primitives
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+
+#define BLEND_ALPHA 0    // The colour drawn over the screen
+#define BLEND_ADD 1      // Channels added, saturating
+#define BLEND_MULTIPLY 2 // Channels multiplied, with full brightness as 1
+#define BLEND_MAX 3      // The brighter of each channel
+
+#define BLEND_OPAQUE 16 // Full strength; each mode is faded towards the screen in sixteenths below this
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void drawHLineBlend(short x, short y, short w, unsigned char colour, int mode, int alpha);
+    void fillRectBlend(short x, short y, short w, short h, unsigned char colour, int mode, int alpha);
+    void fillTriangleBlend(short x0, short y0, short x1, short y1, short x2, short y2, unsigned char colour, int mode, int alpha);
+    void blend_row(unsigned char *dst, const unsigned char *src, int n, int mode, int alpha);
+
+#ifdef __cplusplus
+}
+#endif
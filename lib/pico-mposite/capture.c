@@ -0,0 +1,219 @@
+//
+// Title:	        Pico-mposite Capture
+// Description:		Compressed screen capture stream
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// There's no room to keep a copy of the last frame sent, so each row has a hash instead and only
+// rows whose hash has changed are sent. A row is copied out of the front buffer before being
+// hashed and encoded, so a flip part way through can't tear it, and the copy of the row above is
+// kept for the XOR. One packet is encoded at a time and handed to the write callback for as long
+// as it takes bytes; capture_update returns as soon as it stops, so it never holds up the caller,
+// and the scanout runs from DMA regardless
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+
+#include "capture.h"
+
+#define CAPTURE_MAX_ROWS (VIDEO_TIMING_MAX_ACTIVE * 2)                   // Tallest screen, interlaced
+#define CAPTURE_PACKET (6 + VIDEO_MAX_WIDTH + VIDEO_MAX_WIDTH / 128 + 1) // A row header and the worst case encoding
+
+capture_write_t capture_write; // Where the stream goes, or NULL when stopped
+uint32_t capture_hash[CAPTURE_MAX_ROWS]; // Hash of each row as last sent
+uint32_t capture_row[2][VIDEO_MAX_WIDTH / 4]; // The row being sent and the one above it
+int capture_above;          // Which of capture_row is the row above
+int capture_y;              // Next row to look at, -1 for the frame header, or screenHeight for the frame end
+int capture_width;          // Size of the frame being sent
+int capture_height;
+uint16_t capture_frame;     // Frame number
+uint8_t capture_packet[CAPTURE_PACKET];
+int capture_length;         // Bytes in capture_packet
+int capture_sent;           // Bytes of it sent so far
+bool capture_end;           // Set when capture_packet holds a frame end
+
+// Start streaming
+// - write: Where to send the stream
+//
+void capture_start(capture_write_t write)
+{
+    capture_write = write;
+    capture_length = capture_sent = 0;
+    capture_end = false;
+    capture_y = -1;
+    capture_frame = 0;
+    capture_keyframe();
+}
+
+// Stop streaming; a packet in progress is dropped
+//
+void capture_stop(void)
+{
+    capture_write = NULL;
+}
+
+// Send every row of the next frame, for when the host has just connected or lost its place
+//
+void capture_keyframe(void)
+{
+    memset(capture_hash, 0, sizeof(capture_hash));
+    capture_width = 0; // No frame matches this, so every row is sent
+}
+
+// Hash a row (FNV-1a, a word at a time)
+//
+static uint32_t capture_hash_row(const uint32_t *p, int words)
+{
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < words; i++)
+    {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h | 1; // Never 0, which capture_keyframe uses for not sent
+}
+
+// Encode a row into capture_packet
+// - y: Row number
+// - row, above: The row and the row above it, or NULL for row 0
+// - width: Width in pixels
+//
+static void capture_encode_row(int y, const uint8_t *row, const uint8_t *above, int width)
+{
+    uint8_t *p = capture_packet + 6;
+    int i = 0;
+    while (i < width)
+    {
+        uint8_t b = above ? row[i] ^ above[i] : row[i];
+        int run = 1;
+        while (i + run < width && run < 129 && (above ? row[i + run] ^ above[i + run] : row[i + run]) == b)
+        {
+            run++;
+        }
+        if (run >= 2)
+        {
+            *p++ = run + 126;
+            *p++ = b;
+            i += run;
+            continue;
+        }
+        uint8_t *control = p++; // Literals up to the next run of 3 or more
+        int n = 0;
+        while (i < width && n < 128)
+        {
+            b = above ? row[i] ^ above[i] : row[i];
+            if (i + 2 < width && (above ? row[i + 1] ^ above[i + 1] : row[i + 1]) == b && (above ? row[i + 2] ^ above[i + 2] : row[i + 2]) == b)
+            {
+                break;
+            }
+            *p++ = b;
+            i++;
+            n++;
+        }
+        *control = n - 1;
+    }
+    int length = p - capture_packet - 6;
+    capture_packet[0] = CAPTURE_SYNC;
+    capture_packet[1] = 'R';
+    capture_packet[2] = y;
+    capture_packet[3] = y >> 8;
+    capture_packet[4] = length;
+    capture_packet[5] = length >> 8;
+    capture_length = length + 6;
+}
+
+// Work out the next packet
+// Returns
+// - false if there's nothing to send
+//
+static bool capture_next(void)
+{
+    if (screen_bitmap == NULL)
+    {
+        return false; // A scanline renderer mode, so there's no bitmap to send
+    }
+    if (capture_y < 0)
+    { // Frame header
+        if (screenWidth != capture_width || screenHeight != capture_height)
+        {
+            memset(capture_hash, 0, sizeof(capture_hash)); // New size, so send it all
+            capture_width = screenWidth;
+            capture_height = screenHeight;
+        }
+        uint8_t header[] = {CAPTURE_SYNC, 'F', (uint8_t)capture_frame, (uint8_t)(capture_frame >> 8), (uint8_t)capture_width, (uint8_t)(capture_width >> 8), (uint8_t)capture_height, (uint8_t)(capture_height >> 8), opt_colour};
+        memcpy(capture_packet, header, sizeof(header));
+        capture_length = sizeof(header);
+        capture_y = 0;
+        return true;
+    }
+    if (capture_width != screenWidth || capture_height != screenHeight)
+    {
+        capture_y = -1; // The mode changed part way through, so start again
+        return capture_next();
+    }
+    while (capture_y < capture_height)
+    {
+        int y = capture_y++;
+        uint32_t *row = capture_row[capture_above ^ 1];
+        memcpy(row, &screen_bitmap[screenWidth * screen_row(y)], capture_width);
+        uint32_t h = capture_hash_row(row, capture_width / 4);
+        bool changed = h != capture_hash[y];
+        if (changed)
+        {
+            capture_hash[y] = h;
+            capture_encode_row(y, (const uint8_t *)row, y ? (const uint8_t *)capture_row[capture_above] : NULL, capture_width);
+        }
+        capture_above ^= 1; // This row is now the row above, as the host has it
+        if (changed)
+        {
+            return true;
+        }
+    }
+    uint8_t end[] = {CAPTURE_SYNC, 'E', (uint8_t)capture_frame, (uint8_t)(capture_frame >> 8)};
+    memcpy(capture_packet, end, sizeof(end));
+    capture_length = sizeof(end);
+    capture_end = true;
+    capture_frame++;
+    capture_y = -1;
+    return true;
+}
+
+// Send as much as the connection will take, up to the end of a frame; call from the main loop
+// Returns
+// - false if capture is stopped, there's nothing to send, or a frame has just been finished
+//
+bool capture_update(void)
+{
+    if (capture_write == NULL)
+    {
+        return false;
+    }
+    while (true)
+    {
+        if (capture_sent == capture_length)
+        {
+            capture_sent = capture_length = 0;
+            if (capture_end)
+            {
+                capture_end = false;
+                return false; // At most a frame per call
+            }
+            if (!capture_next())
+            {
+                return false;
+            }
+        }
+        int n = capture_write(capture_packet + capture_sent, capture_length - capture_sent);
+        if (n <= 0)
+        {
+            return true; // Full; carry on next time
+        }
+        capture_sent += n;
+    }
+}
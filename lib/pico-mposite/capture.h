@@ -0,0 +1,49 @@
+//
+// Title:	        Pico-mposite Capture
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Streams the screen to a host as compressed frames, a little at a time from the main loop
+//
+// Stream format, all numbers little endian:
+//
+// Frame header: CAPTURE_SYNC, 'F', frame number (u16), width (u16), height (u16), colour (u8)
+// Row:          CAPTURE_SYNC, 'R', row (u16), length (u16), then length bytes of packed row
+// Frame end:    CAPTURE_SYNC, 'E', frame number (u16)
+//
+// Rows that haven't changed since they were last sent are left out. A row is sent XORed with the
+// row above it as the host has it (nothing for row 0), then run length encoded: a control byte
+// below 128 is followed by that many plus one literal bytes, and one of 128 or more by a single
+// byte repeated (control - 126) times. colour is opt_colour, so the host knows how to show the pixels
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CAPTURE_SYNC 0xa5
+
+// Sends bytes to the host without waiting
+// - data: Bytes to send
+// - length: Number of bytes
+// Returns
+// - Number of bytes taken, which may be 0
+//
+typedef int (*capture_write_t)(const uint8_t *data, int length);
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void capture_start(capture_write_t write);
+    void capture_stop(void);
+    void capture_keyframe(void);
+    bool capture_update(void);
+
+#ifdef __cplusplus
+}
+#endif
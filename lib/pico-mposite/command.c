@@ -0,0 +1,403 @@
+//
+// Title:	        Pico-mposite Command Protocol
+// Description:		Binary drawing commands and display list
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Bytes from the host go through a small state machine that finds the packets and checks their
+// CRC. Each command in a good packet is checked against the opcode table before the packet is
+// copied into the display list, so the list never holds anything that can't be drawn. The table
+// gives each opcode's fixed arguments as a format string, and the commands with data after them
+// (palette, text and images) a function for its length. command_update draws everything up to the
+// last FLIP and keeps the rest for the next frame. A frame too big for the list is drawn into the
+// back buffer a list at a time as it fills, ahead of its FLIP
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+#include "charset.h"
+
+#include "command.h"
+
+#define CMD_MAX_ARGS 10
+
+struct command_op
+{
+    const char *args;             // Argument format: h, c or b per argument
+    int (*tail)(const int *a);    // Bytes of data after the arguments, or NULL for none
+    void (*draw)(const int *a, const uint8_t *data);
+};
+
+struct command_stats command_stats;
+
+uint8_t command_list[CMD_LIST_SIZE]; // The display list
+int command_length;                  // Bytes in it
+int command_flip;                    // Bytes up to and including the last FLIP, or 0 if there isn't one
+
+uint8_t command_packet[CMD_MAX_PAYLOAD + 2]; // Packet being received, with its CRC
+int command_state;                           // Bytes of the packet header seen, 3 once into the payload
+int command_payload;                         // Length of the payload
+int command_received;                        // Bytes of payload and CRC received
+bool command_held;                           // Set when command_packet is waiting for room in the display list
+
+unsigned char command_palette[256]; // Colour lookup for c arguments
+
+// CRC-16/CCITT nibble table
+//
+static const uint16_t crc_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+
+// Work out a CRC-16/CCITT (polynomial 0x1021, starting at 0xffff)
+// - data: Bytes
+// - length: Number of bytes
+// Returns
+// - The CRC
+//
+uint16_t command_crc(const uint8_t *data, int length)
+{
+    uint16_t crc = 0xffff;
+    for (int i = 0; i < length; i++)
+    {
+        crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] & 15)];
+    }
+    return crc;
+}
+
+// The commands
+//
+static void op_flip(const int *a, const uint8_t *d) { swap_video_buffer(); }
+static void op_clear(const int *a, const uint8_t *d) { fillRect(0, 0, screenWidth, screenHeight, a[0]); }
+static void op_border(const int *a, const uint8_t *d) { set_border(a[0]); }
+static void op_palette(const int *a, const uint8_t *d) { memcpy(&command_palette[a[0]], d, a[1] > 256 - a[0] ? 256 - a[0] : a[1]); }
+static void op_scroll(const int *a, const uint8_t *d) { set_scroll(a[0], a[1]); }
+static void op_pixel(const int *a, const uint8_t *d) { drawPixel(a[0], a[1], a[2]); }
+static void op_hline(const int *a, const uint8_t *d) { drawHLine(a[0], a[1], a[2], a[3]); }
+static void op_vline(const int *a, const uint8_t *d) { drawVLine(a[0], a[1], a[2], a[3]); }
+static void op_line(const int *a, const uint8_t *d) { drawLine(a[0], a[1], a[2], a[3], a[4]); }
+static void op_line_thick(const int *a, const uint8_t *d) { drawLineThickness(a[0], a[1], a[2], a[3], a[4], a[5]); }
+static void op_rect(const int *a, const uint8_t *d) { drawRect(a[0], a[1], a[2], a[3], a[4]); }
+static void op_rect_thick(const int *a, const uint8_t *d) { drawRectThickness(a[0], a[1], a[2], a[3], a[4], a[5]); }
+static void op_fill_rect(const int *a, const uint8_t *d) { fillRect(a[0], a[1], a[2], a[3], a[4]); }
+static void op_rect_center(const int *a, const uint8_t *d) { drawRectCenter(a[0], a[1], a[2], a[3], a[4]); }
+static void op_fill_rect_center(const int *a, const uint8_t *d) { fillRectCenter(a[0], a[1], a[2], a[3], a[4]); }
+static void op_round_rect(const int *a, const uint8_t *d) { drawRoundRect(a[0], a[1], a[2], a[3], a[4], a[5]); }
+static void op_fill_round_rect(const int *a, const uint8_t *d) { fillRoundRect(a[0], a[1], a[2], a[3], a[4], a[5]); }
+static void op_ellipse(const int *a, const uint8_t *d) { drawCircle(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); }
+static void op_fill_circle(const int *a, const uint8_t *d) { fillCircle(a[0], a[1], a[2], a[3]); }
+static void op_fill_ellipse(const int *a, const uint8_t *d) { filledElipsisTransparency(a[0], a[1], a[2], a[3], a[4], a[5]); }
+static void op_triangle(const int *a, const uint8_t *d) { drawTriangle(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); }
+static void op_fill_triangle(const int *a, const uint8_t *d) { fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); }
+static void op_rect_rotated(const int *a, const uint8_t *d) { drawRectRotated(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]); }
+static void op_fill_rect_rotated(const int *a, const uint8_t *d) { drawFillRectRotated(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); }
+static void op_ellipse_rotated(const int *a, const uint8_t *d) { drawCircleRotated(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]); }
+static void op_fill_ellipse_rotated(const int *a, const uint8_t *d) { filledElipsisRotated(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); }
+static void op_rect_transparent(const int *a, const uint8_t *d) { drawRectTransparency(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); }
+static void op_fill_rect_transparent(const int *a, const uint8_t *d) { fillRectTransparency(a[0], a[1], a[2], a[3], a[4], a[5]); }
+static void op_rect_center_thick(const int *a, const uint8_t *d) { drawRectCenterThickness(a[0], a[1], a[2], a[3], a[4], a[5]); }
+static void op_star(const int *a, const uint8_t *d) { drawStar(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); }
+static void op_char(const int *a, const uint8_t *d) { drawCharCustomSize(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]); } // drawChar is this with equal scales
+static void op_bitmap(const int *a, const uint8_t *d) { drawImage(a[0], a[1], a[2], a[3], (unsigned char *)d, a[4], a[5], a[6], a[7], a[8], a[9]); }
+
+// Text is drawn straight into the back buffer, as print_char draws on the front buffer
+//
+static void op_text(const int *a, const uint8_t *d)
+{
+    for (int i = 0; i < a[4]; i++)
+    {
+        if (d[i] < 32 || d[i] >= 128)
+        {
+            continue;
+        }
+        for (int row = 0; row < 8; row++)
+        {
+            int y = a[1] + row;
+            unsigned char data = charset[(d[i] - 32) * 8 + row];
+            for (int bit = 0; bit < 8 && y >= 0 && y < screenHeight; bit++)
+            {
+                int x = a[0] + i * 8 + 7 - bit;
+                if (x >= 0 && x < screenWidth)
+                {
+                    screen_bitmap_next[y * screenWidth + x] = colour_base + (data & 1 << bit ? a[2] : a[3]);
+                }
+            }
+        }
+    }
+}
+
+static void op_image(const int *a, const uint8_t *d)
+{
+    int x = a[0], y = a[1], w = a[2], h = a[3];
+    for (int j = 0; j < h; j++, d += w)
+    {
+        int x0 = x < 0 ? 0 : x;
+        int x1 = x + w > screenWidth ? screenWidth : x + w;
+        if (y + j >= 0 && y + j < screenHeight && x0 < x1)
+        {
+            memcpy(&screen_bitmap_next[(y + j) * screenWidth + x0], d + (x0 - x), x1 - x0);
+        }
+    }
+}
+
+static int tail_palette(const int *a) { return a[1]; }
+static int tail_text(const int *a) { return a[4]; }
+static int tail_image(const int *a) { return a[2] < 0 || a[3] < 0 ? -1 : a[2] * a[3]; }
+static int tail_bitmap(const int *a) { return a[4] <= 0 || a[5] <= 0 ? -1 : ((a[4] + 7) & ~7) / 8 * a[5]; }
+
+static const struct command_op command_ops[CMD_OPCODES] = {
+    [CMD_NOP] = {"", NULL, NULL},
+    [CMD_FLIP] = {"", NULL, op_flip},
+    [CMD_CLEAR] = {"c", NULL, op_clear},
+    [CMD_BORDER] = {"c", NULL, op_border},
+    [CMD_PALETTE] = {"bb", tail_palette, op_palette},
+    [CMD_SCROLL] = {"hh", NULL, op_scroll},
+    [CMD_PIXEL] = {"hhc", NULL, op_pixel},
+    [CMD_HLINE] = {"hhhc", NULL, op_hline},
+    [CMD_VLINE] = {"hhhc", NULL, op_vline},
+    [CMD_LINE] = {"hhhhc", NULL, op_line},
+    [CMD_LINE_THICK] = {"hhhhch", NULL, op_line_thick},
+    [CMD_RECT] = {"hhhhc", NULL, op_rect},
+    [CMD_RECT_THICK] = {"hhhhch", NULL, op_rect_thick},
+    [CMD_FILL_RECT] = {"hhhhc", NULL, op_fill_rect},
+    [CMD_RECT_CENTER] = {"hhhhc", NULL, op_rect_center},
+    [CMD_FILL_RECT_CENTER] = {"hhhhc", NULL, op_fill_rect_center},
+    [CMD_ROUND_RECT] = {"hhhhhc", NULL, op_round_rect},
+    [CMD_FILL_ROUND_RECT] = {"hhhhhc", NULL, op_fill_round_rect},
+    [CMD_ELLIPSE] = {"hhhhcbh", NULL, op_ellipse},
+    [CMD_FILL_CIRCLE] = {"hhhc", NULL, op_fill_circle},
+    [CMD_FILL_ELLIPSE] = {"hhhhch", NULL, op_fill_ellipse},
+    [CMD_TRIANGLE] = {"hhhhhhc", NULL, op_triangle},
+    [CMD_FILL_TRIANGLE] = {"hhhhhhc", NULL, op_fill_triangle},
+    [CMD_RECT_ROTATED] = {"hhhhcbhh", NULL, op_rect_rotated},
+    [CMD_FILL_RECT_ROTATED] = {"hhhhchh", NULL, op_fill_rect_rotated},
+    [CMD_ELLIPSE_ROTATED] = {"hhhhcbhh", NULL, op_ellipse_rotated},
+    [CMD_FILL_ELLIPSE_ROTATED] = {"hhhhchh", NULL, op_fill_ellipse_rotated},
+    [CMD_RECT_TRANSPARENT] = {"hhhhcbh", NULL, op_rect_transparent},
+    [CMD_FILL_RECT_TRANSPARENT] = {"hhhhch", NULL, op_fill_rect_transparent},
+    [CMD_RECT_CENTER_THICK] = {"hhhhch", NULL, op_rect_center_thick},
+    [CMD_STAR] = {"hhhhcbh", NULL, op_star},
+    [CMD_CHAR] = {"hhbcchhh", NULL, op_char},
+    [CMD_TEXT] = {"hhccb", tail_text, op_text},
+    [CMD_IMAGE] = {"hhhh", tail_image, op_image},
+    [CMD_BITMAP] = {"hhhhhhccbh", tail_bitmap, op_bitmap},
+};
+
+// Decode a command
+// - p: The command
+// - end: End of the bytes it can use
+// - a: Filled with the arguments; colours are left as palette indexes
+// - data: Set to the data after the arguments
+// Returns
+// - Length of the command, or -1 if it is not valid
+//
+static int command_decode(const uint8_t *p, const uint8_t *end, int *a, const uint8_t **data)
+{
+    const uint8_t *start = p;
+    int *args = a;
+    if (p >= end || *p >= CMD_OPCODES || (command_ops[*p].args == NULL))
+    {
+        return -1;
+    }
+    const struct command_op *op = &command_ops[*p++];
+    for (const char *f = op->args; *f; f++)
+    {
+        if (p + (*f == 'h' ? 2 : 1) > end)
+        {
+            return -1;
+        }
+        *a++ = *f == 'h' ? (int16_t)(p[0] | p[1] << 8) : *p;
+        p += *f == 'h' ? 2 : 1;
+    }
+    *data = p;
+    if (op->tail)
+    {
+        int n = op->tail(args);
+        if (n < 0 || n > end - p)
+        {
+            return -1;
+        }
+        p += n;
+    }
+    return p - start;
+}
+
+// Set up the command protocol, or start it again; clears the display list and the palette
+//
+void initialise_command(void)
+{
+    command_length = command_flip = 0;
+    command_state = 0;
+    command_held = false;
+    for (int i = 0; i < 256; i++)
+    {
+        command_palette[i] = i;
+    }
+    memset(&command_stats, 0, sizeof(command_stats));
+}
+
+// Draw the start of the display list into the back buffer, and drop it from the list
+// - end: Bytes to draw; must be at the end of a command
+//
+static void command_draw(int end)
+{
+    int a[CMD_MAX_ARGS];
+    const uint8_t *data;
+
+    for (int i = 0; i < end;)
+    {
+        const uint8_t *p = &command_list[i];
+        int n = command_decode(p, &command_list[end], a, &data); // Checked when it was added
+        const char *f = command_ops[*p].args;
+        for (int j = 0; f[j]; j++)
+        {
+            if (f[j] == 'c')
+            {
+                a[j] = command_palette[a[j]];
+            }
+        }
+        if (command_ops[*p].draw)
+        {
+            command_ops[*p].draw(a, data);
+        }
+        i += n;
+        if (*p == CMD_FLIP)
+        {
+            command_stats.frames++;
+        }
+    }
+    memmove(command_list, &command_list[end], command_length - end); // Keep the next frame's commands
+    command_length -= end;
+}
+
+// Check a packet and add it to the display list
+// Returns
+// - false if there's no room until command_update has drawn the frame waiting; the packet is
+//   left for it to add
+//
+static bool command_add(const uint8_t *payload, int length)
+{
+    int a[CMD_MAX_ARGS];
+    const uint8_t *data;
+    int flip = 0;
+    for (int i = 0; i < length;)
+    {
+        int n = command_decode(payload + i, payload + length, a, &data);
+        if (n < 0)
+        {
+            command_stats.errors++;
+            return true;
+        }
+        i += n;
+        if (payload[i - n] == CMD_FLIP)
+        {
+            flip = i;
+        }
+    }
+    if (command_length + length > CMD_LIST_SIZE && command_flip == 0)
+    {
+        command_draw(command_length); // A frame bigger than the list; draw what there is of it so far
+        command_stats.flushes++;
+    }
+    if (command_length + length > CMD_LIST_SIZE)
+    {
+        command_stats.waits++; // Waiting on command_update to draw the last frame
+        return false;
+    }
+    memcpy(&command_list[command_length], payload, length);
+    if (flip)
+    {
+        command_flip = command_length + flip;
+    }
+    command_length += length;
+    command_stats.packets++;
+    return true;
+}
+
+// Take bytes from the host
+// - data: Bytes received
+// - length: Number of bytes
+// Returns
+// - Number of bytes taken. This is short of length when a packet has to wait for room in the
+//   display list; pass the rest again after command_update has drawn a frame, and stop reading
+//   from the host meanwhile, so its flow control holds it back rather than packets being lost
+//
+int command_feed(const uint8_t *data, int length)
+{
+    for (int i = 0; i < length; i++)
+    {
+        if (command_held)
+        {
+            return i;
+        }
+        uint8_t b = data[i];
+        switch (command_state)
+        {
+        case 0: // Looking for the start of a packet
+            command_state = b == CMD_SYNC;
+            break;
+        case 1: // Length
+            command_payload = b;
+            command_state = 2;
+            break;
+        case 2:
+            command_payload |= b << 8;
+            command_received = 0;
+            command_state = command_payload <= CMD_MAX_PAYLOAD ? 3 : 0;
+            if (command_state == 0)
+            {
+                command_stats.errors++;
+            }
+            break;
+        default: // Payload and CRC
+        {
+            int n = command_payload + 2 - command_received; // Take as much as is here in one go
+            n = n < length - i ? n : length - i;
+            memcpy(&command_packet[command_received], &data[i], n);
+            command_received += n;
+            i += n - 1;
+            if (command_received == command_payload + 2)
+            {
+                uint16_t crc = command_packet[command_payload] | command_packet[command_payload + 1] << 8;
+                if (crc == command_crc(command_packet, command_payload))
+                {
+                    command_held = !command_add(command_packet, command_payload);
+                }
+                else
+                {
+                    command_stats.errors++;
+                }
+                command_state = 0;
+            }
+            break;
+        }
+        }
+    }
+    return length;
+}
+
+// Draw the display list up to the last FLIP; call once a frame
+// Returns
+// - true if a frame was drawn
+//
+bool command_update(void)
+{
+    if (command_flip == 0)
+    {
+        return false;
+    }
+    command_draw(command_flip);
+    command_flip = 0;
+    if (command_held)
+    {
+        command_held = !command_add(command_packet, command_payload); // There's room for it now
+    }
+    return true;
+}
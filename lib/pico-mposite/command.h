@@ -0,0 +1,94 @@
+//
+// Title:	        Pico-mposite Command Protocol
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Binary drawing commands from a host, collected into a display list and drawn a frame at a time
+//
+// Packet: CMD_SYNC, payload length (u16), payload, CRC-16/CCITT of the payload (u16)
+//
+// The payload is a run of commands, each an opcode followed by its arguments: h is a signed 16 bit
+// number, c a colour (looked up in the command palette) and b an unsigned byte. All numbers are
+// little endian. Commands are held until a FLIP arrives, then everything up to the FLIP is drawn
+// into the back buffer and shown. If the display list fills up before a FLIP, what is in it is
+// drawn into the back buffer there and then to make room, so a frame can be any size. If it fills
+// up with a frame waiting to be shown, command_feed stops taking bytes until command_update has
+// drawn it, so the host is held back by its flow control instead of packets being lost. See
+// tools/command_client.c for a host side implementation
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CMD_SYNC 0x7e
+#define CMD_MAX_PAYLOAD 2048 // Largest packet payload
+#define CMD_LIST_SIZE 16384  // Display list, in bytes
+
+// Opcodes, with their arguments
+//
+#define CMD_NOP 0x00
+#define CMD_FLIP 0x01              // Show the frame
+#define CMD_CLEAR 0x02             // c
+#define CMD_BORDER 0x03            // c
+#define CMD_PALETTE 0x04           // b first, b count, then count colours
+#define CMD_SCROLL 0x05            // h x, h y
+#define CMD_PIXEL 0x10             // h x, h y, c
+#define CMD_HLINE 0x11             // h x, h y, h w, c
+#define CMD_VLINE 0x12             // h x, h y, h h, c
+#define CMD_LINE 0x13              // h x0, h y0, h x1, h y1, c
+#define CMD_LINE_THICK 0x14        // h x0, h y0, h x1, h y1, c, h thickness
+#define CMD_RECT 0x15              // h x, h y, h w, h h, c
+#define CMD_RECT_THICK 0x16        // h x, h y, h w, h h, c, h thickness
+#define CMD_FILL_RECT 0x17         // h x, h y, h w, h h, c
+#define CMD_RECT_CENTER 0x18       // h x, h y, h w, h h, c
+#define CMD_FILL_RECT_CENTER 0x19  // h x, h y, h w, h h, c
+#define CMD_ROUND_RECT 0x1a        // h x, h y, h w, h h, h r, c
+#define CMD_FILL_ROUND_RECT 0x1b   // h x, h y, h w, h h, h r, c
+#define CMD_ELLIPSE 0x1c           // h x, h y, h w, h h, c, b thickness, h transparency
+#define CMD_FILL_CIRCLE 0x1d       // h x, h y, h r, c
+#define CMD_FILL_ELLIPSE 0x1e      // h x, h y, h w, h h, c, h transparency
+#define CMD_TRIANGLE 0x1f          // h x0, h y0, h x1, h y1, h x2, h y2, c
+#define CMD_FILL_TRIANGLE 0x20     // h x0, h y0, h x1, h y1, h x2, h y2, c
+#define CMD_RECT_ROTATED 0x21      // h x, h y, h w, h h, c, b thickness, h transparency, h angle
+#define CMD_FILL_RECT_ROTATED 0x22 // h x, h y, h w, h h, c, h transparency, h angle
+#define CMD_ELLIPSE_ROTATED 0x23   // h x, h y, h w, h h, c, b thickness, h transparency, h angle
+#define CMD_FILL_ELLIPSE_ROTATED 0x24 // h x, h y, h w, h h, c, h transparency, h angle
+#define CMD_RECT_TRANSPARENT 0x25  // h x, h y, h w, h h, c, b thickness, h transparency
+#define CMD_FILL_RECT_TRANSPARENT 0x26 // h x, h y, h w, h h, c, h transparency
+#define CMD_RECT_CENTER_THICK 0x27 // h x, h y, h w, h h, c, h thickness
+#define CMD_STAR 0x28              // h x, h y, h w, h h, c, b thickness, h transparency
+#define CMD_CHAR 0x29              // h x, h y, b character, c foreground, c background, h width scale, h height scale, h transparency
+#define CMD_TEXT 0x30              // h x, h y, c foreground, c background, b length, then the characters
+#define CMD_IMAGE 0x31             // h x, h y, h w, h h, then w * h pixels, a row at a time
+#define CMD_BITMAP 0x32            // h x, h y, h w, h h, h bitmap w, h bitmap h, c foreground, c background, b fast, h transparency,
+                                   // then the 1 bit bitmap, rows padded to 8 pixels, as drawImage takes it
+#define CMD_OPCODES 0x33
+
+struct command_stats
+{
+    uint32_t packets;  // Packets added to the display list
+    uint32_t errors;   // Packets dropped for a bad CRC, length or command
+    uint32_t waits;    // Packets held back because the display list was full with a frame waiting to be shown
+    uint32_t flushes;  // Times a frame too big for the display list was drawn early to make room
+    uint32_t frames;   // Frames drawn
+};
+
+extern struct command_stats command_stats;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void initialise_command(void);
+    int command_feed(const uint8_t *data, int length);
+    bool command_update(void);
+    uint16_t command_crc(const uint8_t *data, int length);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,12 +6,22 @@
 //
 // Modinfo:
 // 27//09/2024:		Version 1.3
+// 18/10/2026:      Added opt_triple_buffer
+//                  Added opt_max_width
+//                  Added opt_capture
+//                  Added opt_command
+//                  Added opt_profile
 
 #pragma once
 
 #define version         "1.3"
 #define opt_colour      1       // Set to 0 for monochrome board, 1 for colour board
 #define opt_terminal    0       // Set to 1 to just run the terminal software after boot screen
+#define opt_triple_buffer 0     // Set to 1 to allocate a third video buffer so swap_video_buffer never waits for vblank
+#define opt_max_width   320     // Widest bitmap mode the video memory is sized for (256, 320 or 640); two 640 buffers won't fit in RAM
+#define opt_capture     0       // Set to 1 to stream the screen over USB serial, for tools/capture_decode
+#define opt_command     0       // Set to 1 to draw commands sent over USB serial, from tools/command_client
+#define opt_profile     0       // Set to 1 to time the graphics primitives, see profile.h
 
 // Selecciona el sistema de video: 0 = PAL, 1 = NTSC
 #define VIDEO_NTSC 0
\ No newline at end of file
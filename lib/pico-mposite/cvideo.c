@@ -7,87 +7,29 @@
 #include "hardware/pio.h"
 #include "hardware/dma.h"
 #include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
 
 #include "charset.h" // The character set
 #include "cvideo.h"
 #include "graphics.h"
+#include "profile.h"
 #include "cvideo_sync.pio.h" // The assembled PIO code
 #include "cvideo_data.pio.h"
 
-// --- PAL/NTSC: Defines de líneas y rangos de sincronía/border ---
-#if VIDEO_NTSC
-#define NTSC_TOTAL_LINES 524
-#define NTSC_FIELD_LINES 249 // era 269. 321 para 312pixeles de alto. 309 para 240 pero raro
-#define NTSC_VSYNC_START 1
-#define NTSC_VSYNC_END 6
-#define NTSC_VSYNC_SHORT_START 7
-#define NTSC_VSYNC_SHORT_END 9
-#define NTSC_BORDER_TOP_START 0
-#define NTSC_BORDER_TOP_END 0        // antes 38
-#define NTSC_BORDER_BOTTOM_START 270 // antes 223
-#define NTSC_BORDER_BOTTOM_END 262
-#else
-#define VIDEO_TOTAL_LINES 258
-#define VSYNC_LL1_START 1
-#define VSYNC_LL1_END 2
-#define VSYNC_LS_LINE 3
-#define VSYNC_SS_START 4
-#define VSYNC_SS_END 5
-#define BORDER_TOP_START 6
-#define BORDER_TOP_END 18
-#define BORDER_BOTTOM_START 307
-#define BORDER_BOTTOM_END 309
-#endif
-
-#define HSYNC_TABLE_SIZE 32
+#define HSYNC_TABLE_SIZE VIDEO_SYNC_ENTRIES
 
 int screenWidth = 320;
-int screenHeight = 240;
+int screenHeight = VIDEO_HEIGHT;
 
-#if VIDEO_NTSC
-int ntsc_field = 0; // 0: even, 1: odd
-#endif
-
-#if VIDEO_NTSC
-unsigned short hsync[HSYNC_TABLE_SIZE] = {
-    HSLO, HSLO, HSHI, HSHI, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, BORD};
-#else //para PAL:
-unsigned short hsync[HSYNC_TABLE_SIZE] = {
-    HSLO, HSLO, HSHI, HSHI, HSHI, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, BORD};
-    #endif
-
-unsigned short border[HSYNC_TABLE_SIZE] = {
-    HSLO, HSLO, HSHI, HSHI, HSHI, HSHI, BORD, // sync pulses + 1 borde izq
-    BORD, BORD, BORD, BORD, BORD, BORD, BORD,
-    BORD, BORD, BORD, BORD, BORD, BORD, BORD,
-    BORD, BORD, BORD, BORD, BORD, BORD, BORD,
-    BORD, BORD, BORD, BORD // área de borde
-};
-
-unsigned short vsync_ll[HSYNC_TABLE_SIZE] = {
-    VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSHI, // 16
-    VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSHI  // 32
-};
-
-unsigned short vsync_ss[HSYNC_TABLE_SIZE] = {
-    VSLO, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, // 16
-    VSLO, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI  // 32
-};
-
-unsigned short vsync_ls[HSYNC_TABLE_SIZE] = {
-    VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSHI, // 16
-    VSLO, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI  // 32
-};
+const struct video_timing *video_timing = NULL;       // The current timing
+const struct video_timing *next_timing;               // Timing waiting to be switched to by the ISR
+struct video_sync_tables sync_tables[2];              // Generated sync tables; the current ones and a spare
+struct video_sync_tables *sync_set = &sync_tables[0]; // The sync tables being played out
+struct video_sync_tables *volatile sync_pending;      // Set by set_video_timing, cleared once the ISR has switched to them
+unsigned short border_level = BORD | colour_base;     // Border entry in the sync tables
+struct video_clock_plan video_clock;                  // Clock dividers for the current timing
+struct video_clock_plan next_clock;                   // Clock dividers for the pending timing
 
 PIO pio_0;     // The PIO that this uses
 uint offset_0; // Program offsets
@@ -96,20 +38,315 @@ uint offset_1;
 uint dma_channel_0; // DMA channel for transferring sync data to PIO
 uint dma_channel_1; // DMA channel for transferring pixel data data to PIO
 uint vline;         // Current PAL(ish) video line being processed
-uint bline;         // Line in the bitmap to fetch
+uint bline;         // Next scan line to fetch; the framebuffer row is bline >> line_shift
+uint brow;          // Next scan line to fetch when a raster table is in use
+uint rline;         // Active line the sync DMA is being set up for
+uint line_step = 1; // Scan lines per line; 2 when interlaced, so each field shows every other one
+uint line_shift;    // 1 in the line doubled modes, where each framebuffer row is shown twice
+uint scan_lines = VIDEO_HEIGHT; // Scan lines in a frame; screenHeight << line_shift
+bool rows_restart;              // Set by commit_timing for the PIO ISR to start again from the first row
+
+volatile uint vblank_count; // Vblank counter
+
+unsigned char *screen_bitmap = NULL;       // Buffer being scanned out
+unsigned char *screen_bitmap_next = NULL;  // Buffer being drawn into
+unsigned char *screen_bitmap_ready = NULL; // Triple buffering: finished frame waiting to be shown
+
+unsigned char video_arena[VIDEO_ARENA_SIZE] __attribute__((aligned(4))); // The video buffers are carved out of this
+
+volatile bool flip_pending; // Set by swap_video_buffer, cleared once the ISR has latched the flip
+spin_lock_t *flip_lock;     // Guards the buffer pointer exchange between the renderer and the ISR
+
+struct raster_line *raster_table = NULL;              // Per-scanline effects, or NULL for none
+unsigned short raster_hsync[2][HSYNC_TABLE_SIZE];     // Sync tables with a per-line border colour applied
+uint32_t data_clkdiv;                                 // Pixel clock divider for the current mode
+
+int scroll_x;                // Hardware scroll: pixel offset into each row, a multiple of 4
+int scroll_y;                // Hardware scroll: framebuffer row shown on the first active line
+int video_scroll_x;          // The scroll being shown, latched from scroll_x and scroll_y between frames
+int video_scroll_y;
+volatile bool scroll_pending; // Set when scroll_x and scroll_y have changed, cleared once the ISR has latched them
+bool scroll_set;             // Set by set_scroll, cleared by swap_video_buffer
+
+scanline_renderer_t scanline_renderer = NULL;       // Generates each line at scanout instead of reading a bitmap
+uint32_t scanline_buffer[2][VIDEO_MAX_WIDTH / 4];   // Line being scanned out, and the one being generated
+uint scanline_index;                                // Which of the two line buffers is next to be scanned out
+
+unsigned char video_palette[2][256];                // Palette the bitmap is looked up through, and the spare
+uint video_palette_index;                           // Which of video_palette is in use
+bool palette_enabled;                               // Set when the bitmap holds palette indices
+bool palette_next;                                  // palette_enabled once the pending palette is latched
+volatile bool palette_pending;                      // Set by set_palette, cleared once the ISR has latched it
+
+struct video_mode // A mode change waiting to be committed by the ISR
+{
+    int mode;                                   // Mode number
+    int width;                                  // Screen width in pixels
+    int height;                                 // Screen height in pixels
+    uint line_step;                             // Scan lines per line
+    uint line_shift;                            // Scan lines per framebuffer row, as a shift
+    uint32_t clkdiv;                            // Pixel clock divider, in SMx_CLKDIV format
+    scanline_renderer_t renderer;               // Scanline renderer, or NULL for a bitmap mode
+    unsigned char *buffers[VIDEO_BUFFERS];      // Video buffers, front buffer first
+};
 
-uint vblank_count; // Vblank counter
+struct video_mode next_mode;
+volatile bool mode_pending; // Set by set_mode, cleared once the ISR has committed next_mode
+int video_mode;             // The current mode number
 
-unsigned char *screen_bitmap = NULL;
-unsigned char *screen_bitmap_next = NULL;
-unsigned char *screen_bitmap_a = NULL;
-unsigned char *screen_bitmap_b = NULL;
+// The primitives draw into the back buffer without the hardware scroll, so a flip puts the
+// scroll back to 0 unless set_scroll has been called for the new frame; called with flip_lock
+// held, so the scroll is latched with the flip
+//
+static inline void flip_scroll(void)
+{
+    if (!scroll_set && (scroll_x || scroll_y))
+    {
+        scroll_x = 0;
+        scroll_y = 0;
+        scroll_pending = true;
+    }
+    scroll_set = false;
+}
 
+// Request a buffer flip
+// The flip itself is latched by cvideo_pio_handler just before the first active line of the
+// next frame, so the scanout never changes buffer mid-frame. With two buffers this waits for
+// the latch, as the old front buffer is still being read until then. With three buffers the
+// finished frame is exchanged with the spare buffer and this returns straight away; if the
+// renderer gets a whole frame ahead, the newest frame replaces the one still waiting
+//
 void swap_video_buffer()
 {
+#if opt_profile
+    profile_frame_end();
+#endif
+    uint32_t save = spin_lock_blocking(flip_lock);
+#if opt_triple_buffer
+    unsigned char *tmp = screen_bitmap_ready;
+    screen_bitmap_ready = screen_bitmap_next;
+    screen_bitmap_next = tmp;
+#endif
+    flip_scroll();
+    flip_pending = true;
+    spin_unlock(flip_lock, save);
+#if !opt_triple_buffer
+    while (flip_pending)
+    {
+        tight_loop_contents();
+    }
+#endif
+}
+
+// Latch a pending flip; called from the ISR between frames
+//
+static inline void latch_video_buffer(void)
+{
+    spin_lock_unsafe_blocking(flip_lock);
     unsigned char *tmp = screen_bitmap;
+#if opt_triple_buffer
+    screen_bitmap = screen_bitmap_ready; // Show the finished frame
+    screen_bitmap_ready = tmp;           // The old front buffer becomes the spare
+#else
     screen_bitmap = screen_bitmap_next;
     screen_bitmap_next = tmp;
+#endif
+    flip_pending = false;
+    spin_unlock_unsafe(flip_lock);
+}
+
+// Latch a pending scroll; called from the ISR between frames
+//
+static inline void latch_scroll(void)
+{
+    video_scroll_x = scroll_x;
+    video_scroll_y = scroll_y;
+    scroll_pending = false;
+}
+
+// Latch a pending palette; called from the ISR between frames
+//
+static inline void latch_palette(void)
+{
+    if (palette_next)
+    {
+        video_palette_index ^= 1; // set_palette filled in the spare
+    }
+    palette_enabled = palette_next;
+    palette_pending = false;
+}
+
+// Look up a bitmap row through the palette into a line buffer, four pixels a word
+// - dst: Line buffer to fill
+// - row: Screen row; the hardware scroll is applied here
+//
+static void __not_in_flash_func(palette_line)(uint32_t *dst, uint row)
+{
+    row += video_scroll_y;
+    if (row >= screenHeight)
+    {
+        row -= screenHeight;
+    }
+    const uint32_t *src = (const uint32_t *)&screen_bitmap[screenWidth * row + video_scroll_x];
+    const unsigned char *p = video_palette[video_palette_index];
+    for (int i = 0; i < screenWidth / 4; i++)
+    {
+        uint32_t w = src[i];
+        dst[i] = p[w & 0xff] | p[(w >> 8) & 0xff] << 8 | p[(w >> 16) & 0xff] << 16 | (uint32_t)p[w >> 24] << 24;
+    }
+}
+
+// The modes; the doubled modes run the pixel clock at half the rate and/or show each row twice
+//
+static const struct
+{
+    short width;      // Pixels
+    char rate;        // Pixel rate, from the three in the timing descriptor
+    char x_shift;     // 1 to double the pixel width
+    char line_shift;  // 1 to double the line height
+} mode_table[] = {
+    {256, 0, 0, 0}, // 0: 256x240
+    {320, 1, 0, 0}, // 1: 320x240
+    {640, 2, 0, 0}, // 2: 640x240
+    {160, 1, 1, 0}, // 3: 160x240
+    {320, 1, 0, 1}, // 4: 320x120
+    {160, 1, 1, 1}, // 5: 160x120
+};
+
+// Work out the parameters for a mode and carve its buffers out of the video arena
+// - mode: The graphics mode (0 = 256x240, 1 = 320x240, 2 = 640x240, 3 = 160x240, 4 = 320x120, 5 = 160x120)
+// - renderer: Scanline renderer, or NULL for a bitmap mode
+// - timing: The timing it is for, which sets the height
+// - clock: The clock dividers for that timing
+// Returns
+// - 0 if successful, -1 if the bitmap doesn't fit in the arena (see opt_max_width)
+//
+// If there isn't room for all the buffers, as with the interlaced timings, a single buffer is
+// used for them all; drawing then goes straight to the screen
+//
+static int prepare_mode(int mode, scanline_renderer_t renderer, const struct video_timing *timing, const struct video_clock_plan *clock)
+{
+    if (mode < 0 || mode >= sizeof(mode_table) / sizeof(mode_table[0]))
+    {
+        mode = 0;
+    }
+    int width = mode_table[mode].width;
+    int height = (timing->interlaced ? timing->active_lines * 2 : timing->active_lines) >> mode_table[mode].line_shift;
+
+    for (int i = 0; i < VIDEO_BUFFERS; i++)
+    {
+        next_mode.buffers[i] = NULL;
+    }
+    if (renderer == NULL)
+    {
+        size_t size = VIDEO_BUFFER_SIZE(width, height);
+        int count = VIDEO_BUFFERS * size > sizeof(video_arena) ? 1 : VIDEO_BUFFERS;
+        if (size > sizeof(video_arena))
+        {
+            return -1;
+        }
+        for (int i = 0; i < VIDEO_BUFFERS; i++)
+        {
+            next_mode.buffers[i] = &video_arena[(i % count) * size];
+        }
+    }
+    next_mode.mode = mode;
+    next_mode.width = width;
+    next_mode.height = height;
+    next_mode.line_step = timing->interlaced ? 2 : 1;
+    next_mode.line_shift = mode_table[mode].line_shift;
+    next_mode.clkdiv = clock->pixel_clkdiv[mode_table[mode].rate] << mode_table[mode].x_shift; // Pixel dot frequency for the mode
+    next_mode.renderer = renderer;
+    return 0;
+}
+
+// Commit next_mode; called from the ISR once the last active line has been fetched, so the
+// width, DMA transfer count, pixel clock and buffers all change together between frames
+//
+static inline void commit_mode(void)
+{
+    video_mode = next_mode.mode;
+    screenWidth = next_mode.width;
+    screenHeight = next_mode.height;
+    line_step = next_mode.line_step;
+    line_shift = next_mode.line_shift;
+    scan_lines = screenHeight << line_shift;
+    scroll_x = 0;
+    scroll_y = 0;
+    latch_scroll();
+    dma_channel_set_trans_count(dma_channel_1, screenWidth / 4, false); // Words; takes effect on the next trigger
+    data_clkdiv = next_mode.clkdiv;
+    pio_0->sm[sm_data].clkdiv = data_clkdiv;
+
+    screen_bitmap = next_mode.buffers[0];
+    screen_bitmap_next = next_mode.buffers[1];
+#if opt_triple_buffer
+    screen_bitmap_ready = next_mode.buffers[2];
+#endif
+    flip_pending = false;
+    if (screen_bitmap)
+    {
+        memset(screen_bitmap, colour_base, screenWidth); // The rest is cleared by set_mode during vblank
+    }
+
+    scanline_renderer = next_mode.renderer;
+    scanline_index = 0;
+    if (scanline_renderer)
+    {
+        scanline_renderer((unsigned char *)scanline_buffer[0], 0); // Have the first line ready
+    }
+    mode_pending = false;
+}
+
+// The sync table values for the board
+//
+static inline struct video_sync_levels sync_levels(void)
+{
+    struct video_sync_levels levels = {HSLO, HSHI, VSLO, VSHI, border_level};
+    return levels;
+}
+
+// Switch to the pending timing, and the mode prepared for it; called from the DMA ISR at the
+// end of a frame. If the frame ends in a bottom border, the PIO ISR has already wrapped and set
+// up the first line of the next frame from the old mode, so that one line is shown as it was, but
+// the display has to resync to the new timing anyway; the row counters carry on from the line
+// after it. Otherwise the last active line is still to come, and the PIO ISR starts again from
+// the first row when it is done
+//
+static inline void commit_timing(void)
+{
+    bool wrapped = bline < scan_lines;
+    video_timing = next_timing;
+    video_clock = next_clock;
+    sync_set = sync_pending;
+    pio_0->sm[sm_sync].clkdiv = video_clock.sync_clkdiv;
+    commit_mode();
+    if (wrapped)
+    {
+        bline = line_step;
+        brow = line_step;
+        if (scanline_renderer) // commit_mode generated row 0, which has been set up already
+        {
+            scanline_renderer((unsigned char *)scanline_buffer[0], line_step >> line_shift);
+        }
+        else if (palette_enabled)
+        {
+            palette_line(scanline_buffer[0], line_step >> line_shift);
+        }
+    }
+    else
+    {
+        rows_restart = true;
+    }
+    sync_pending = NULL;
+}
+
+// The first scan line of the field after a given line
+// - line: The scan line past the end of a field
+//
+static inline uint next_field_line(uint line)
+{
+    return line_step == 2 && !(line & 1) ? 1 : 0; // After the even field comes the odd one
 }
 
 int initialise_cvideo(void)
@@ -126,8 +363,24 @@ int initialise_cvideo(void)
 
     vline = 1;        // Initialise the video scan line counter to 1
     bline = 0;        // And the index into the bitmap pixel buffer to 0
+    rline = 0;
     vblank_count = 0; // And the vblank counter
 
+    flip_lock = spin_lock_instance(spin_lock_claim_unused(true)); // Claim a spinlock for buffer flips
+#if opt_profile
+    initialise_profile();
+#endif
+
+    // Generate the sync tables
+    //
+    if (video_timing == NULL)
+    {
+        video_timing = VIDEO_NTSC ? &video_timing_ntsc : &video_timing_pal;
+    }
+    struct video_sync_levels levels = sync_levels();
+    video_timing_build(video_timing, &levels, sync_set);
+    video_clock_plan(clock_get_hz(clk_sys), video_timing, &video_clock);
+
     // Initialise the first PIO (video sync)
     //
     pio_sm_set_enabled(pio_0, sm_sync, false); // Disable the PIO state machine
@@ -138,7 +391,7 @@ int initialise_cvideo(void)
         offset_0,                              // And offset
         gpio_base,                             // Start pin in the GPIO
         gpio_count,                            // Number of pins
-        piofreq_0                              // State machine clock frequency
+        video_clock.sync_clkdiv / 65536.0      // State machine clock divider
     );
     cvideo_configure_pio_dma( // Configure the DMA
         pio_0,                // The PIO to attach this DMA to
@@ -149,13 +402,6 @@ int initialise_cvideo(void)
         cvideo_dma_handler    // The DMA handler
     );
 
-    // Allocate double buffers
-    size_t bufsize = screenWidth * screenHeight;
-    screen_bitmap_a = malloc(bufsize);
-    screen_bitmap_b = malloc(bufsize);
-    screen_bitmap = screen_bitmap_a;
-    screen_bitmap_next = screen_bitmap_b;
-
     // Initialise the second PIO (pixel data)
     //
     cvideo_data_initialise_pio(
@@ -164,19 +410,28 @@ int initialise_cvideo(void)
         offset_1,
         gpio_base,
         gpio_count,
-        piofreq_1_256);
+        video_clock.pixel_clkdiv[0] / 65536.0);
 
     // Initialise the DMA
     //
     cvideo_configure_pio_dma(
         pio_0,
         sm_data,
-        dma_channel_1, // On DMA channel 1
-        DMA_SIZE_8,    // Size of each transfer
-        screenWidth,   // The bitmap screenWidth
-        NULL           // But there is no DMA interrupt for the pixel data
+        dma_channel_1,   // On DMA channel 1
+        DMA_SIZE_32,     // Size of each transfer; four pixels at a time
+        screenWidth / 4, // The bitmap screenWidth in words
+        NULL             // But there is no DMA interrupt for the pixel data
     );
 
+    // Set up the video buffers for the default mode
+    //
+    if (prepare_mode(1, NULL, video_timing, &video_clock) < 0)
+    {
+        prepare_mode(0, NULL, video_timing, &video_clock);
+    }
+    commit_mode();
+    memset(video_arena, colour_base, sizeof(video_arena));
+
     irq_set_exclusive_handler( // Set up the PIO IRQ handler
         PIO0_IRQ_0,            // The IRQ #
         cvideo_pio_handler     // And handler routine
@@ -184,9 +439,7 @@ int initialise_cvideo(void)
     pio0_hw->inte0 = PIO_IRQ0_INTE_SM0_BITS; // Just for IRQ 0 (triggered by irq set 0 in PIO)
     irq_set_enabled(PIO0_IRQ_0, true);       // Enable it
 
-    set_border(0);                          // Set the border colour
-    clearScreen(0);                         // Clear the screen (front buffer)
-    memset(screen_bitmap_next, 0, bufsize); // Clear the back buffer
+    set_border(0); // Set the border colour
 
     // Start the PIO state machines
     //
@@ -194,54 +447,121 @@ int initialise_cvideo(void)
     return 0;
 }
 
+// Hand next_mode to the ISR and wait for it to be committed at the end of the frame
+//
+static void post_mode(void)
+{
+    mode_pending = true;
+    while (mode_pending)
+    {
+        tight_loop_contents();
+    }
+}
+
 // Set the graphics mode
-// mode - The graphics mode (0 = 256x192, 1 = 320 x 192, 2 = 640 x 192)
+// mode - The graphics mode (0 = 256x240, 1 = 320x240, 2 = 640x240, 3 = 160x240, 4 = 320x120,
+//        5 = 160x120); twice the height with an interlaced timing
+// Returns
+// - 0 if successful, -1 if the mode is bigger than opt_max_width allows
+//
+// No memory is allocated. The switch happens between frames, and the new buffers are cleared
+// during the vertical blank that follows, so the old mode is shown right up until the new one
 //
 int set_mode(int mode)
 {
-    double dfreq;
+    if (prepare_mode(mode, NULL, video_timing, &video_clock) < 0)
+    {
+        return -1;
+    }
+    post_mode();
 
-    wait_vblank();
+    size_t size = VIDEO_BUFFER_SIZE(screenWidth, screenHeight);
+    memset(screen_bitmap + screenWidth, colour_base, size - screenWidth); // Ahead of the scanout; the ISR cleared the first row
+    for (int i = 1; i < VIDEO_BUFFERS; i++)
+    {
+        if (next_mode.buffers[i] != screen_bitmap)
+        {
+            memset(next_mode.buffers[i], colour_base, size);
+        }
+    }
+    return 0;
+}
 
-    switch (mode)
-    { // Get the video mode
-    case 1:
-        screenWidth = 320;     // Set screen screenWidth and
-        dfreq = piofreq_1_320; // pixel dot frequency accordingly
-        break;
-    case 2:
-        screenWidth = 640;
-        dfreq = piofreq_1_640;
-        break;
-    default:
-        screenWidth = 256;
-        dfreq = piofreq_1_256;
-        break;
+// Set a mode whose pixels are generated a line at a time during scanout
+// The bitmap buffers are not used, so the bitmap drawing functions must not be used in these modes
+// mode - The graphics mode, as set_mode
+// renderer - Called from the ISR to fill in each line; it has the whole of the previous line to do so
+// Returns
+// - 0 if successful, -1 if there is no renderer or the mode can't be set up
+//
+int set_scanline_mode(int mode, scanline_renderer_t renderer)
+{
+    if (renderer == NULL || prepare_mode(mode, renderer, video_timing, &video_clock) < 0)
+    {
+        return -1;
     }
-    // Free and reallocate both buffers if mode changes
-    if (screen_bitmap_a)
-        free(screen_bitmap_a);
-    if (screen_bitmap_b)
-        free(screen_bitmap_b);
-    size_t bufsize = screenWidth * screenHeight;
-    screen_bitmap_a = malloc(bufsize);
-    screen_bitmap_b = malloc(bufsize);
-    screen_bitmap = screen_bitmap_a;
-    screen_bitmap_next = screen_bitmap_b;
-    clearScreen(0);
-    memset(screen_bitmap_next, 0, bufsize);
-
-    cvideo_configure_pio_dma( // Reconfigure the DMA
-        pio_0,
-        sm_data,
-        dma_channel_1, // On DMA channel 1
-        DMA_SIZE_8,    // Size of each transfer
-        screenWidth,   // The bitmap screenWidth
-        NULL           // But there is no DMA interrupt for the pixel data
-    );
+    post_mode();
+    return 0;
+}
 
-    pio_0->sm[sm_data].clkdiv = (uint32_t)(dfreq * (1 << 16));
+// Set the video timing
+// - timing: The timing descriptor, such as video_timing_pal or video_timing_ntsc; it must stay in scope
+// Returns
+// - 0 if successful, -1 if the descriptor is invalid or the current mode won't fit
+//
+// Can be called before initialise_cvideo to override the default from VIDEO_NTSC. Afterwards the
+// new tables are generated into the spare set and switched to between frames, along with the
+// current mode resized to suit; a bitmap is left uncleared
+//
+int set_video_timing(const struct video_timing *timing)
+{
+    if (video_timing_validate(timing) < 0)
+    {
+        return -1;
+    }
+    if (video_timing == NULL)
+    {
+        video_timing = timing; // Not running yet; initialise_cvideo generates the tables
+        return 0;
+    }
+    video_clock_plan(clock_get_hz(clk_sys), timing, &next_clock);
+    if (prepare_mode(video_mode, scanline_renderer, timing, &next_clock) < 0)
+    {
+        return -1;
+    }
+    struct video_sync_tables *spare = sync_set == &sync_tables[0] ? &sync_tables[1] : &sync_tables[0];
+    struct video_sync_levels levels = sync_levels();
+    video_timing_build(timing, &levels, spare);
+    next_timing = timing;
+    sync_pending = spare; // Before mode_pending, so cvideo_pio_handler leaves the mode to commit_timing
+    mode_pending = true;
+    while (sync_pending)
+    {
+        tight_loop_contents();
+    }
+    return 0;
+}
+
+// Set the system clock to get the colour subcarrier as close to exact as possible
+// - timing: The timing whose subcarrier is wanted
+// - min_hz, max_hz: Range of system clocks to consider
+// Returns
+// - 0 if successful, -1 if no system clock in the range can be made
+//
+// Call this before initialise_cvideo and anything else that depends on the system clock, such as
+// the UART; the video dividers are then planned from the new clock. The subcarrier error is in
+// video_clock.subcarrier_error_ppm afterwards
+//
+int set_sys_clock_for_video(const struct video_timing *timing, uint32_t min_hz, uint32_t max_hz)
+{
+    uint32_t vco_hz;
+    int postdiv1, postdiv2;
 
+    if (video_clock_pick_sys(timing->subcarrier_hz, min_hz, max_hz, &vco_hz, &postdiv1, &postdiv2) == 0)
+    {
+        return -1;
+    }
+    set_sys_clock_pll(vco_hz, postdiv1, postdiv2);
     return 0;
 }
 
@@ -256,13 +576,70 @@ void set_border(unsigned char colour)
     }
     unsigned short c = BORD | (colour_base + colour);
 
-    for (int i = 6; i < HSYNC_TABLE_SIZE; i++)
-    { // Skip the first tres hsync values
-        if (hsync[i] & BORD)
-        {                 // If the border bit is set in the hsync
-            hsync[i] = c; // Then write out the new colour (with the BORD bit set)
+    border_level = c;
+    for (int i = video_timing->border_start; i < HSYNC_TABLE_SIZE; i++)
+    { // Skip the sync pulse and back porch
+        if (sync_set->hsync[i] & BORD)
+        {                       // If the border bit is set in the hsync
+            sync_set->hsync[i] = c; // Then write out the new colour (with the BORD bit set)
         }
-        border[i] = c; // We can just write the values out to the border table
+        sync_set->border[i] = c; // We can just write the values out to the border table
+    }
+}
+
+// Set the palette for a palette indexed bitmap
+// - palette: 256 colours, one for each pixel value, or NULL to show the pixel values directly again
+//
+// The palette is copied, and switched to at the start of the next frame, so it can be changed once
+// a frame for cycling and fades without touching the bitmap or tearing. While one is set, each row
+// is looked up into the scanline buffer a line ahead of the scanout, like a scanline renderer; the
+// raster table is ignored, and the primitives still add colour_base, so on the mono board pixel
+// colour c is palette[colour_base + c]. It has no effect in the scanline renderer modes
+//
+void set_palette(const unsigned char *palette)
+{
+    palette_pending = false; // Keep the ISR off the spare while it is filled in
+    if (palette)
+    {
+        memcpy(video_palette[video_palette_index ^ 1], palette, 256);
+    }
+    palette_next = palette != NULL;
+    palette_pending = true;
+}
+
+// Set the hardware scroll position
+// - x: Pixel offset into each row, rounded down to a multiple of 4 as the pixels are fetched a
+//      word at a time; pixels past the end of a row come from the start of the next
+// - y: Framebuffer row shown at the top of the screen
+//
+// The framebuffer is treated as circular, so scrolling costs nothing; see scroll_up and screen_row.
+// The scroll is switched to at the start of the next frame, like a flip. The primitives draw into
+// the back buffer without it, so swap_video_buffer puts it back to 0 unless it is set again for
+// the new frame first; print_char and scroll_up, which draw on the front buffer, follow it
+//
+void set_scroll(int x, int y)
+{
+    scroll_pending = false; // Keep the ISR off scroll_x and scroll_y while they are changed
+    x %= screenWidth;
+    y %= screenHeight;
+    scroll_x = (x < 0 ? x + screenWidth : x) & ~3;
+    scroll_y = y < 0 ? y + screenHeight : y;
+    scroll_set = true;
+    scroll_pending = true;
+}
+
+// Set the per-scanline effects table
+// - table: One entry per active line (screenHeight entries, or twice that in the line doubled modes), or NULL to switch effects off
+//
+// The table is read by the ISRs as each line is set up, so entries can be changed at any time;
+// changes made during vblank take effect cleanly on the next frame
+//
+void set_raster_table(struct raster_line *table)
+{
+    raster_table = table;
+    if (table == NULL)
+    {
+        pio_0->sm[sm_data].clkdiv = data_clkdiv; // Undo any per-line pixel clock
     }
 }
 
@@ -283,81 +660,163 @@ void wait_vblank(void)
 //
 void cvideo_pio_handler(void)
 {
-    if (bline >= screenHeight)
+    PROFILE_ISR();
+    if (bline >= scan_lines || rows_restart)
     {
-        bline = 0;
+        bline = rows_restart ? 0 : next_field_line(bline);
+        brow = bline;
+        rows_restart = false;
+        if (bline == 0)
+        {
+            if (mode_pending && !sync_pending)
+            {
+                commit_mode(); // Commit any mode change or flip before the first active line is fetched
+            }
+            else if (flip_pending)
+            {
+                latch_video_buffer();
+            }
+            if (scroll_pending)
+            {
+                latch_scroll(); // With any flip, as swap_video_buffer sets both under flip_lock
+            }
+            if (palette_pending)
+            {
+                latch_palette();
+            }
+            if (palette_enabled && !scanline_renderer)
+            {
+                palette_line(scanline_buffer[scanline_index], 0); // With the new bitmap and palette; there's all of vblank to do it
+            }
+        }
     }
-    dma_channel_set_read_addr(dma_channel_1, &screen_bitmap[screenWidth * bline++], true); // Line up the next block of pixels
-    hw_set_bits(&pio0->irq, 1u);                                                           // Reset the IRQ
-}
-
-// The DMA interrupt handler
-// This feeds the state machine cvideo_sync with data for the PAL(ish) video signal
-//
-void cvideo_dma_handler(void)
-{
-#if VIDEO_NTSC
-    // NTSC "no entrelazado": 262 líneas por campo, sin media línea
-    int field_line = vline;
-    // VSYNC: 6 líneas de long sync, 3 de short sync (puedes ajustar si tu capturadora es muy exigente)
-    if (field_line >= NTSC_VSYNC_START && field_line <= NTSC_VSYNC_END)
+    if (scanline_renderer || palette_enabled)
     {
-        dma_channel_set_read_addr(dma_channel_0, vsync_ll, true);
+        uint row = bline >> line_shift;
+        dma_channel_set_read_addr(dma_channel_1, scanline_buffer[scanline_index], true); // Scan out the line generated last time
+        bline += line_step;
+        uint next = bline >= scan_lines ? next_field_line(bline) : bline;
+        if ((next >> line_shift) != row || bline >= scan_lines)
+        {
+            scanline_index ^= 1;
+            if (scanline_renderer)
+            {
+                scanline_renderer((unsigned char *)scanline_buffer[scanline_index], next >> line_shift); // And generate the one after
+            }
+            else
+            {
+                palette_line(scanline_buffer[scanline_index], next >> line_shift);
+            }
+        }
     }
-    else if (field_line >= NTSC_VSYNC_SHORT_START && field_line <= NTSC_VSYNC_SHORT_END)
+    else if (raster_table == NULL)
     {
-        dma_channel_set_read_addr(dma_channel_0, vsync_ss, true);
+        uint row = (bline >> line_shift) + video_scroll_y;
+        bline += line_step;
+        if (row >= screenHeight)
+        {
+            row -= screenHeight;
+        }
+        dma_channel_set_read_addr(dma_channel_1, &screen_bitmap[screenWidth * row + video_scroll_x], true); // Line up the next block of pixels
     }
-    else if (field_line >= NTSC_BORDER_TOP_START && field_line <= NTSC_BORDER_TOP_END)
+    else
     {
-        dma_channel_set_read_addr(dma_channel_0, border, true);
+        const struct raster_line *r = &raster_table[bline];
+        int row = (r->flags & RASTER_REPEAT) && brow >= line_step ? brow - line_step : brow; // Repeated lines show the previous row again
+        if (row == brow)
+        {
+            brow += line_step;
+        }
+        bline += line_step;
+        int x = (r->xoffset & ~3) + video_scroll_x; // Word aligned for the DMA
+        row = (row >> line_shift) + r->yoffset + video_scroll_y;
+        if (x < 0)
+        {
+            x += screenWidth; // Negative offsets start in the row above
+            row--;
+        }
+        else if (x >= screenWidth)
+        {
+            x -= screenWidth;
+            row++;
+        }
+        while (row < 0)
+            row += screenHeight;
+        while (row >= screenHeight)
+            row -= screenHeight;
+        pio_0->sm[sm_data].clkdiv = r->flags & RASTER_CLKDIV ? (uint32_t)r->clkdiv << 8 : data_clkdiv;
+        dma_channel_set_read_addr(dma_channel_1, &screen_bitmap[screenWidth * row + x], true);
     }
-    else if (field_line >= NTSC_BORDER_BOTTOM_START && field_line <= NTSC_BORDER_BOTTOM_END)
+    hw_set_bits(&pio0->irq, 1u); // Reset the IRQ
+}
+
+// Pick the sync table for the next active line, applying any per-line border colour
+//
+static inline const unsigned short *active_sync_table(void)
+{
+    uint line = rline;
+    rline += line_step;
+    if (rline >= scan_lines)
     {
-        dma_channel_set_read_addr(dma_channel_0, border, true);
+        rline = next_field_line(rline);
     }
-    else
+    if (raster_table == NULL || line >= scan_lines || !(raster_table[line].flags & RASTER_BORDER))
     {
-        dma_channel_set_read_addr(dma_channel_0, hsync, true);
+        return sync_set->hsync;
     }
-    // Flip de campo y reset cada 262 líneas
-    if (vline++ >= NTSC_FIELD_LINES)
+    unsigned short *t = raster_hsync[line & 1]; // Alternate so the table being read is never rewritten
+    unsigned short c = BORD | (colour_base + raster_table[line].border);
+    for (int i = 0; i < HSYNC_TABLE_SIZE; i++)
     {
-        vline = 1;
-        ntsc_field ^= 1;
-        vblank_count++;
+        t[i] = sync_set->hsync[i] & BORD ? c : sync_set->hsync[i];
     }
-#else
-    switch (vline)
+    return t;
+}
+
+// The DMA interrupt handler
+// This feeds the state machine cvideo_sync with data for the video signal, following the
+// line schedule generated from the timing descriptor
+//
+void cvideo_dma_handler(void)
+{
+    PROFILE_ISR();
+    switch (sync_set->schedule[vline])
     {
-    case VSYNC_LL1_START ... VSYNC_LL1_END:
-        dma_channel_set_read_addr(dma_channel_0, vsync_ll, true);
+    case LINE_VSYNC_LONG:
+        dma_channel_set_read_addr(dma_channel_0, sync_set->vsync_ll, true);
+        break;
+    case LINE_VSYNC_LONG_SHORT:
+        dma_channel_set_read_addr(dma_channel_0, sync_set->vsync_ls, true);
         break;
-    case VSYNC_LS_LINE:
-        dma_channel_set_read_addr(dma_channel_0, vsync_ls, true);
+    case LINE_VSYNC_SHORT:
+        dma_channel_set_read_addr(dma_channel_0, sync_set->vsync_ss, true);
         break;
-    case VSYNC_SS_START ... VSYNC_SS_END:
-    case 310:
-    case 311:
-    case 312:
-        dma_channel_set_read_addr(dma_channel_0, vsync_ss, true);
+    case LINE_VSYNC_SHORT_LONG:
+        dma_channel_set_read_addr(dma_channel_0, sync_set->vsync_sl, true);
         break;
-    case BORDER_TOP_START ... BORDER_TOP_END:
-        dma_channel_set_read_addr(dma_channel_0, border, true);
+    case LINE_SHORT_BLANK:
+        dma_channel_set_read_addr(dma_channel_0, sync_set->short_blank, true);
         break;
-    case BORDER_BOTTOM_START ... 309:
-        dma_channel_set_read_addr(dma_channel_0, border, true);
+    case LINE_BLANK_SHORT:
+        dma_channel_set_read_addr(dma_channel_0, sync_set->blank_short, true);
+        break;
+    case LINE_ACTIVE:
+        dma_channel_set_read_addr(dma_channel_0, active_sync_table(), true);
         break;
     default:
-        dma_channel_set_read_addr(dma_channel_0, hsync, true);
+        dma_channel_set_read_addr(dma_channel_0, sync_set->border, true);
         break;
     }
-    if (vline++ >= VIDEO_TOTAL_LINES)
+    if (vline++ >= video_timing->total_lines)
     {
         vline = 1;
         vblank_count++;
+        rline = 0;
+        if (sync_pending)
+        {
+            commit_timing(); // Switch timing between fields
+        }
     }
-#endif
     dma_hw->ints0 = 1u << dma_channel_0;
 }
 
@@ -367,7 +826,7 @@ void cvideo_dma_handler(void)
 // - sm: The state machine number
 // - dma_channel: The DMA channel
 // - transfer_size: Size of each DMA bus transfer (DMA_SIZE_8, DMA_SIZE_16 or DMA_SIZE_32)
-// - buffer_size_words: Number of bytes to transfer
+// - buffer_size: Number of transfers, each of transfer_size
 // - handler: Address of the interrupt handler, or NULL for no interrupts
 //
 void cvideo_configure_pio_dma(PIO pio, uint sm, uint dma_channel, uint transfer_size, size_t buffer_size, irq_handler_t handler)
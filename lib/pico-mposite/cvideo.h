@@ -12,24 +12,36 @@
 // 20/02/2022:      Bitmap is now dynamically allocated
 // 01/03/2022:      Tweaked sync parameters for colour version
 // 26/09/2024:		Externed variables
+// 18/10/2026:      Buffer flips latched by the ISR at the first active line, optional triple buffering
+//                  Added per-scanline raster effects table
+//                  Added hardware scrolling
+//                  Added scanline renderer modes
+//                  Video buffers carved from a static arena, mode changes committed by the ISR
+//                  Timing now comes from a video_timing descriptor, selectable at runtime
+//                  Added interlaced scanout
+//                  Clock dividers planned from the actual system clock
+//                  Pixels are fetched as 32 bit words
+//                  Added the pixel and line doubled modes 3, 4 and 5
+//                  Added palette indexed bitmaps
 
 #pragma once
 
 #include "config.h"
+#include "video_timing.h"
+#include "video_clock.h"
 
-// --- velocidad de pixeles RGB lineales ---
-#if VIDEO_NTSC
-#define piofreq_0 (5.45f * 2)      // NTSC sync
-#define piofreq_1_256 (8.30f * 2)  //resolucion no usada
-#define piofreq_1_320 (7.0f * 2) // NTSC pixel data
-#define piofreq_1_640 (2.52f * 2)  //resolucion no usada
+#if opt_triple_buffer
+#define VIDEO_BUFFERS 3 // Front, back and a spare for the finished frame
 #else
-#define piofreq_0 (5.25f * 2)     // PAL sync
-#define piofreq_1_256 (6.00f * 2) //resolucion no usada
-#define piofreq_1_320 (6.70f * 2)// PAL pixel data
-#define piofreq_1_640 (2.80f * 2) //resolucion no usada
+#define VIDEO_BUFFERS 2
 #endif
 
+#define VIDEO_MAX_WIDTH 640 // Widest mode, in pixels
+#define VIDEO_HEIGHT 240    // Active lines in the progressive timings
+
+#define VIDEO_BUFFER_SIZE(w, h) ((w) * ((h) + 1))                                     // A bitmap with a spare row, so a scrolled last row can't read past the end
+#define VIDEO_ARENA_SIZE (VIDEO_BUFFERS * VIDEO_BUFFER_SIZE(opt_max_width, VIDEO_HEIGHT)) // Static video memory
+
 #define sm_sync 0 // State machine number in the PIO for the sync data
 #define sm_data 1 // State machine number in the PIO for the pixel data
 
@@ -55,18 +67,59 @@
 #define gpio_count 10
 #endif
 
+// Per-scanline raster effect ("copper list"), one entry per active line; in the line doubled
+// modes that is two entries per framebuffer row
+//
+#define RASTER_BORDER 0x01 // Use border for this line
+#define RASTER_CLKDIV 0x02 // Use clkdiv as this line's pixel clock divider
+#define RASTER_REPEAT 0x04 // Show the same framebuffer row as the previous line
+
+struct raster_line
+{
+    short xoffset;         // Pixel offset into the framebuffer row (-screenWidth to screenWidth - 1), rounded down to a multiple of 4
+    short yoffset;         // Row offset added to the framebuffer row (wraps around the screen)
+    unsigned short clkdiv; // Pixel clock divider, 8.8 fixed point
+    unsigned char border;  // Border colour
+    unsigned char flags;   // RASTER_ flags
+};
+
+// Generates one line of pixels at scanout, for modes without a bitmap
+// - dst: Line buffer to fill, screenWidth pixels, word aligned
+// - line: Active line number
+//
+typedef void (*scanline_renderer_t)(unsigned char *dst, int line);
+
+extern scanline_renderer_t scanline_renderer;
+
 extern unsigned char *screen_bitmap;
 extern unsigned char *screen_bitmap_next;
 
+extern const struct video_timing *video_timing;
+extern struct video_clock_plan video_clock;
+
 extern int screenWidth;
 extern int screenHeight;
 
+extern int scroll_x;
+extern int scroll_y;
+
+// Convert a screen row to a framebuffer row, taking the hardware scroll into account
+//
+static inline int screen_row(int y)
+{
+    y += scroll_y;
+    return y >= screenHeight ? y - screenHeight : y;
+}
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
     int initialise_cvideo(void);
     int set_mode(int mode);
+    int set_scanline_mode(int mode, scanline_renderer_t renderer);
+    int set_video_timing(const struct video_timing *timing);
+    int set_sys_clock_for_video(const struct video_timing *timing, uint32_t min_hz, uint32_t max_hz);
 
     void cvideo_configure_pio_dma(PIO pio, uint sm, uint dma_channel, uint transfer_size, size_t buffer_size, irq_handler_t handler);
 
@@ -75,7 +128,10 @@ extern "C"
 
     void wait_vblank(void);
     void set_border(unsigned char colour);
-    // Double buffer support
+    void set_raster_table(struct raster_line *table);
+    void set_scroll(int x, int y);
+    void set_palette(const unsigned char *palette);
+    // Double / triple buffer support
     void swap_video_buffer();
 
 #ifdef __cplusplus
@@ -58,7 +58,7 @@ void cvideo_data_initialise_pio(PIO pio, uint sm, uint offset, uint pin_base, ui
     pio_sm_config c = cvideo_data_program_get_default_config(offset);
     sm_config_set_out_pins(&c, pin_base, pin_count);
     sm_config_set_in_pins(&c, pin_base);
-    sm_config_set_out_shift(&c, false, true, 8);
+    sm_config_set_out_shift(&c, true, true, 32);     // Autopull a word of four pixels, leftmost in the low byte
     pio_sm_init(pio, sm, offset, &c);
     pio->sm[sm].clkdiv = (uint32_t) (freq * (1 << 16));
 }
@@ -0,0 +1,155 @@
+//
+// Title:	        Pico-mposite Dithering
+// Description:		24 bit RGB to screen pixels
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Each channel is quantised through a table to the nearest level (8 for red and green, 4 for blue,
+// or 16 of brightness on the mono board). For error diffusion the difference is spread 7/16 ahead
+// and 3/16, 5/16 and 1/16 into the row below, in whole sixteenths so everything stays in integers;
+// alternate rows run right to left to break up the diagonal worms. The ordered dither adds an 8x8
+// Bayer bias of up to half a level step before quantising, so each pixel only depends on itself.
+//
+// Nothing here uses the Pico SDK, so tools/convert_image.c builds it for the host as it is
+//
+// Modinfo:
+#include <string.h>
+
+#include "dither.h"
+
+// Bayer threshold for a pixel, 0 to 63
+//
+static inline int dither_bayer(int x, int y)
+{
+    int v = 0;
+    for (int bit = 0; bit < 3; bit++) // Interleave the bits of x ^ y and y, least significant first
+    {
+        int xb = (x ^ y) >> bit & 1;
+        int yb = y >> bit & 1;
+        v = v << 2 | xb << 1 | yb;
+    }
+    return v;
+}
+
+// Get ready to convert an image
+// - d: The converter
+// - width: Pixels in a row, up to DITHER_MAX_WIDTH
+// - format: DITHER_COLOUR or DITHER_MONO
+// - method: DITHER_FLOYD_STEINBERG or DITHER_ORDERED
+// - base: Added to every pixel; colour_base for the screen
+// Returns
+// - 0 if successful, -1 if the width or format is out of range
+//
+int dither_start(struct dither *d, int width, int format, int method, uint8_t base)
+{
+    static const int colour_levels[3] = {8, 8, 4};
+    static const int mono_levels[1] = {16};
+    const int *levels = format == DITHER_MONO ? mono_levels : colour_levels;
+
+    if (width <= 0 || width > DITHER_MAX_WIDTH || (format != DITHER_COLOUR && format != DITHER_MONO))
+    {
+        return -1;
+    }
+    d->width = width;
+    d->method = method;
+    d->channels = format == DITHER_MONO ? 1 : 3;
+    d->row = 0;
+    d->base = base;
+    for (int c = 0; c < d->channels; c++)
+    {
+        int n = levels[c] - 1;
+        for (int v = 0; v < 256; v++)
+        {
+            d->quant[c][v] = (v * n + 127) / 255;
+        }
+        for (int q = 0; q <= n; q++)
+        {
+            d->level[c][q] = q * 255 / n;
+        }
+    }
+    memset(d->error, 0, sizeof(d->error));
+    return 0;
+}
+
+// Pack the levels of a pixel
+//
+static inline uint8_t dither_pack(const struct dither *d, const int *q)
+{
+    if (d->channels == 1)
+    {
+        return d->base + q[0];
+    }
+    return d->base + (q[2] << 6 | q[1] << 3 | q[0]); // As rgb(), with blue's 2 bits at the top
+}
+
+// Get the channels of an input pixel
+//
+static inline void dither_input(const struct dither *d, const uint8_t *p, int *v)
+{
+    if (d->channels == 1)
+    {
+        v[0] = (p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8; // Luma
+    }
+    else
+    {
+        v[0] = p[0];
+        v[1] = p[1];
+        v[2] = p[2];
+    }
+}
+
+// Convert the next row
+// - d: The converter
+// - rgb: The row, width pixels of R, G, B bytes
+// - dst: Where the pixels go, width bytes; can be a row of the screen
+//
+void dither_row(struct dither *d, const uint8_t *rgb, uint8_t *dst)
+{
+    int n = d->channels;
+    int v[3], q[3];
+
+    if (d->method == DITHER_ORDERED)
+    {
+        int y = d->row & 7;
+        for (int x = 0; x < d->width; x++)
+        {
+            int t = 2 * dither_bayer(x & 7, y) - 63; // -63 to 63
+            dither_input(d, &rgb[x * 3], v);
+            for (int c = 0; c < n; c++)
+            {
+                int step = d->level[c][1];
+                int e = v[c] + (t * step >> 7);
+                q[c] = d->quant[c][e < 0 ? 0 : e > 255 ? 255 : e];
+            }
+            dst[x] = dither_pack(d, q);
+        }
+        d->row++;
+        return;
+    }
+
+    int16_t *cur = d->error[d->row & 1] + n; // Index -1 is the spare at the left
+    int16_t *next = d->error[~d->row & 1] + n;
+    int dir = d->row & 1 ? -1 : 1;
+    int x = dir > 0 ? 0 : d->width - 1;
+
+    memset(next - n, 0, (d->width + 2) * n * sizeof(int16_t));
+    for (int i = 0; i < d->width; i++, x += dir)
+    {
+        dither_input(d, &rgb[x * 3], v);
+        for (int c = 0; c < n; c++)
+        {
+            int e = v[c] + ((cur[x * n + c] + 8) >> 4);
+            e = e < 0 ? 0 : e > 255 ? 255 : e;
+            q[c] = d->quant[c][e];
+            e -= d->level[c][q[c]];
+            cur[(x + dir) * n + c] += e * 7;
+            next[(x - dir) * n + c] += e * 3;
+            next[x * n + c] += e * 5;
+            next[(x + dir) * n + c] += e;
+        }
+        dst[x] = dither_pack(d, q);
+    }
+    d->row++;
+}
@@ -0,0 +1,51 @@
+//
+// Title:	        Pico-mposite Dithering
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Converts 24 bit RGB to screen pixels a row at a time, with Floyd-Steinberg error diffusion or an
+// 8x8 ordered dither. Rows go in top to bottom, as R, G, B bytes, and only the error for the
+// current row and the next is kept, so images can be streamed or generated a row at a time.
+//
+// The colour board's pixels are 3 bits of red and green and 2 of blue, packed as rgb() does; the
+// mono board's are 16 levels of brightness. dither.c only needs the C library, so the same code
+// converts assets on the host (see tools/convert_image.c) and live content on the Pico
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+
+#define DITHER_MAX_WIDTH 640 // Widest row
+
+#define DITHER_FLOYD_STEINBERG 0 // Error diffusion, serpentine scan
+#define DITHER_ORDERED 1         // 8x8 Bayer matrix
+
+#define DITHER_COLOUR 0 // Pixels for the colour board
+#define DITHER_MONO 1   // Pixels for the mono board
+
+struct dither
+{
+    int width;                                       // Pixels in a row
+    int method;                                      // DITHER_FLOYD_STEINBERG or DITHER_ORDERED
+    int channels;                                    // 3 for colour, 1 for mono
+    int row;                                         // Rows converted so far
+    uint8_t base;                                    // Added to every pixel; colour_base on the Pico
+    uint8_t quant[3][256];                           // Level for each input value, per channel
+    uint8_t level[3][16];                            // Input value each level stands for, up to 16 on the mono board
+    int16_t error[2][(DITHER_MAX_WIDTH + 2) * 3];    // Diffused error in 1/16ths, for this row and the next, with a pixel spare at each end
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int dither_start(struct dither *d, int width, int format, int method, uint8_t base);
+    void dither_row(struct dither *d, const uint8_t *rgb, uint8_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
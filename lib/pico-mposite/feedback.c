@@ -0,0 +1,195 @@
+//
+// Title:	        Pico-mposite Feedback
+// Description:		Affine feedback from the front buffer into the back buffer
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Each pixel of the back buffer is mapped back to a point in the front buffer, stepping a 16.16
+// source position along the row, so there is no per pixel multiply beyond the row offset. The
+// mapping is linear, so if both ends of a row land on the screen every pixel between them does, and
+// those rows take a path with no edge checks; only rows that cross an edge are checked per pixel.
+// Four samples are packed into each word written. The top half of the screen is done on core 0 and
+// the bottom half on core 1 through the worker.
+//
+// The RP2040 interpolators aren't used: their wrapping works on power of two sizes, which the
+// screen isn't, and the one on core 1 belongs to whatever job the worker is running
+//
+// Modinfo:
+#include <Arduino.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "feedback.h"
+#include "worker.h"
+
+const struct feedback *feedback_job; // The warp being done, for the core 1 job
+const unsigned char *feedback_src;    // The front buffer as it was when the warp started
+unsigned char feedback_identity[256]; // Used when there's no decay table
+bool feedback_ready;                  // Set once feedback_identity is filled in
+
+// Set the transform for a warp
+// - f: The warp
+// - zoom: Scale applied to the picture each frame, 8.8; above 256 zooms in, and it is kept to 64 (0.25)
+//   or more so the source positions fit in 16.16
+// - angle: Degrees to rotate it clockwise each frame
+// - dx, dy: Pixels to move it by
+//
+// All about the centre of the screen. The picture moves as: dest = centre + zoom * rotate(src - centre) + d,
+// so the source of each pixel is the inverse of that
+//
+void feedback_transform(struct feedback *f, int zoom, int angle, int dx, int dy)
+{
+    angle %= 360;
+    if (angle < 0)
+    {
+        angle += 360;
+    }
+    if (zoom < 64)
+    {
+        zoom = 64;
+    }
+    int32_t c = cosTable[angle] * 16384 / zoom; // Q10 over 8.8 gives 16.16
+    int32_t s = sinTable[angle] * 16384 / zoom;
+    int32_t cx = screenWidth / 2 + dx;
+    int32_t cy = screenHeight / 2 + dy;
+
+    f->ux = c;
+    f->vx = -s;
+    f->uy = s;
+    f->vy = c;
+    f->u0 = (int32_t)(((int64_t)screenWidth / 2 << 16) - (int64_t)c * cx - (int64_t)s * cy);
+    f->v0 = (int32_t)(((int64_t)screenHeight / 2 << 16) + (int64_t)s * cx - (int64_t)c * cy);
+}
+
+// Reflect or wrap a coordinate back onto the screen
+//
+static inline int feedback_edge(int x, int size, int edge)
+{
+    if (edge == FEEDBACK_MIRROR)
+    {
+        x %= size * 2;
+        if (x < 0)
+        {
+            x += size * 2;
+        }
+        return x < size ? x : size * 2 - 1 - x;
+    }
+    x %= size;
+    return x < 0 ? x + size : x;
+}
+
+// Sample one pixel of the front buffer, for rows that cross an edge
+//
+static inline uint32_t feedback_sample(const struct feedback *f, const unsigned char *src, const unsigned char *lut, int32_t u, int32_t v)
+{
+    int x = u >> 16;
+    int y = v >> 16;
+    if ((unsigned)x >= (unsigned)screenWidth || (unsigned)y >= (unsigned)screenHeight)
+    {
+        if (f->edge == FEEDBACK_CLEAR)
+        {
+            return colour_base + f->fill;
+        }
+        x = feedback_edge(x, screenWidth, f->edge);
+        y = feedback_edge(y, screenHeight, f->edge);
+    }
+    return lut[src[y * screenWidth + x]];
+}
+
+// Warp a band of rows into screen_bitmap_next
+// - y0, y1: First row and the row after the last
+//
+static void __not_in_flash_func(feedback_band)(const struct feedback *f, int y0, int y1)
+{
+    const unsigned char *lut = f->decay ? f->decay : feedback_identity;
+    const unsigned char *src = feedback_src;
+    int w = screenWidth;
+    int32_t ux = f->ux, vx = f->vx;
+
+    for (int y = y0; y < y1; y++)
+    {
+        int32_t u = f->u0 + f->uy * y;
+        int32_t v = f->v0 + f->vy * y;
+        int32_t ue = u + ux * (w - 1);
+        int32_t ve = v + vx * (w - 1);
+        uint32_t *p = (uint32_t *)&screen_bitmap_next[y * w];
+
+        if ((uint32_t)(u >> 16) < (uint32_t)w && (uint32_t)(ue >> 16) < (uint32_t)w &&
+            (uint32_t)(v >> 16) < (uint32_t)screenHeight && (uint32_t)(ve >> 16) < (uint32_t)screenHeight)
+        {
+            for (int i = 0; i < w; i += 4)
+            {
+                uint32_t d = lut[src[(v >> 16) * w + (u >> 16)]];
+                u += ux;
+                v += vx;
+                d |= lut[src[(v >> 16) * w + (u >> 16)]] << 8;
+                u += ux;
+                v += vx;
+                d |= lut[src[(v >> 16) * w + (u >> 16)]] << 16;
+                u += ux;
+                v += vx;
+                d |= (uint32_t)lut[src[(v >> 16) * w + (u >> 16)]] << 24;
+                u += ux;
+                v += vx;
+                *p++ = d;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < w; i += 4)
+            {
+                uint32_t d = 0;
+                for (int j = 0; j < 32; j += 8)
+                {
+                    d |= feedback_sample(f, src, lut, u, v) << j;
+                    u += ux;
+                    v += vx;
+                }
+                *p++ = d;
+            }
+        }
+    }
+}
+
+// The core 1 job; it does the bottom half of the screen
+//
+static uint32_t feedback_band_job(uint32_t arg)
+{
+    feedback_band(feedback_job, arg, screenHeight);
+    return 0;
+}
+
+// Warp the front buffer into the back buffer; uses core 1 if the worker has been started
+// - f: The warp, from feedback_transform or filled in directly
+// Returns
+// - 0 if successful, -1 if there's no separate back buffer to warp into, as in the scanline
+//   renderer modes or with a single buffer for the interlaced timings
+//
+// The buffers are read as they are stored, so any hardware scroll is not taken into account
+//
+int feedback_warp(const struct feedback *f)
+{
+    if (screen_bitmap == NULL || screen_bitmap == screen_bitmap_next)
+    {
+        return -1;
+    }
+    if (!feedback_ready)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            feedback_identity[i] = i;
+        }
+        feedback_ready = true;
+    }
+    feedback_job = f;
+    feedback_src = screen_bitmap; // Read once, so a flip latched part way through can't mix frames
+    worker_start(feedback_band_job, screenHeight / 2);
+    feedback_band(f, 0, screenHeight / 2);
+    worker_wait();
+    return 0;
+}
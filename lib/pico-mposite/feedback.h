@@ -0,0 +1,40 @@
+//
+// Title:	        Pico-mposite Feedback
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Video feedback: the front buffer is zoomed, rotated and moved into the back buffer, on both cores,
+// for the next frame to draw over
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+
+#define FEEDBACK_WRAP 0   // Samples off one edge of the screen come from the opposite edge
+#define FEEDBACK_MIRROR 1 // Samples off an edge are reflected back into the screen
+#define FEEDBACK_CLEAR 2  // Samples off an edge are the fill colour
+
+struct feedback
+{
+    int32_t ux, vx;             // Source step for each pixel along a row, 16.16
+    int32_t uy, vy;             // Source step for each row
+    int32_t u0, v0;             // Source position of the top left pixel
+    int edge;                   // FEEDBACK_WRAP, FEEDBACK_MIRROR or FEEDBACK_CLEAR
+    unsigned char fill;         // Colour for FEEDBACK_CLEAR
+    const unsigned char *decay; // Applied to each sample, 256 entries such as from palette_blend, or NULL
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void feedback_transform(struct feedback *f, int zoom, int angle, int dx, int dy);
+    int feedback_warp(const struct feedback *f);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,198 @@
+//
+// Title:	        Pico-mposite Fractal Renderer
+// Description:		Progressive dual core Mandelbrot
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Coordinates are Q4.28, so the iteration is all 32x32 to 64 bit multiplies with no floating
+// point. The screen is drawn in passes of 8x8, 4x4, 2x2 and then single pixels, each pass only
+// calculating the pixels the one before skipped. Rows in a pass are interleaved between the two
+// cores; core 1 is given an iteration budget through the worker and hands back what it used. Orbits are checked for periodicity, so the inside of the set, which would
+// otherwise always cost the full iteration limit, usually exits early
+//
+// Modinfo:
+// 18/10/2026:      Core 1 is driven through the shared worker
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "fractal.h"
+#include "worker.h"
+
+#define FRACTAL_BAILOUT (4LL << (FRACTAL_FRAC * 2)) // Escape radius squared, in the Q8.56 of the squares
+#define FRACTAL_PERIOD_MAX 256                      // Longest orbit period to look for
+
+#if opt_colour == 0
+unsigned char fractal_palette[16] = { // Index 0 is the inside of the set
+    0, 1, 2, 3, 4, 5, 6, 7,
+    8, 9, 10, 11, 12, 13, 14, 15};
+#else
+unsigned char fractal_palette[16] = {
+    rgb(0, 0, 0), rgb(1, 0, 0), rgb(2, 0, 0), rgb(3, 0, 0),
+    rgb(4, 0, 0), rgb(5, 0, 0), rgb(6, 0, 0), rgb(7, 0, 0),
+    rgb(7, 1, 0), rgb(7, 2, 0), rgb(7, 3, 0), rgb(7, 4, 0),
+    rgb(7, 5, 0), rgb(7, 6, 0), rgb(7, 7, 0), rgb(7, 7, 4)};
+#endif
+
+struct fractal_view fractal_view_current; // View being drawn
+unsigned char *fractal_dst;               // Bitmap being drawn into
+int fractal_width;                        // And its size
+int fractal_height;
+int fractal_block;                        // Block size of the current pass, or 0 when the picture is finished
+int fractal_row[2];                       // Next row each core draws in the current pass
+
+// Iterate one point
+// - cr, ci: The point, Q4.28
+// - max_iter: Iteration limit
+// - used: Incremented by the number of iterations run
+// Returns
+// - Iterations to escape, or max_iter if the point is inside the set
+//
+static int __not_in_flash_func(fractal_iterate)(int32_t cr, int32_t ci, int max_iter, uint32_t *used)
+{
+    int32_t x = 0, y = 0;
+    int32_t px = 0, py = 0; // Saved orbit point for the periodicity check
+    int period = 8, count = 0;
+
+    for (int k = 0; k < max_iter; k++)
+    {
+        int64_t xx = (int64_t)x * x;
+        int64_t yy = (int64_t)y * y;
+        if (xx + yy > FRACTAL_BAILOUT)
+        {
+            *used += k;
+            return k;
+        }
+        y = (int32_t)(((int64_t)x * y) >> (FRACTAL_FRAC - 1)) + ci; // 2xy + ci
+        x = (int32_t)((xx - yy) >> FRACTAL_FRAC) + cr;              // x^2 - y^2 + cr
+        if (x == px && y == py)
+        {
+            *used += k;
+            return max_iter; // Back on a point already visited, so the orbit is a cycle
+        }
+        if (++count == period)
+        {
+            count = 0;
+            px = x;
+            py = y;
+            if (period < FRACTAL_PERIOD_MAX)
+            {
+                period <<= 1;
+            }
+        }
+    }
+    *used += max_iter;
+    return max_iter;
+}
+
+// Draw one row of the current pass
+// - y: Screen row
+// Returns
+// - Iterations used
+//
+static uint32_t __not_in_flash_func(fractal_draw_row)(int y)
+{
+    uint32_t used = 0;
+    int block = fractal_block;
+    int h = y + block > fractal_height ? fractal_height - y : block;
+    int skip = block < FRACTAL_BLOCK && (y & block) == 0; // Even columns of even rows were drawn by the pass before
+    int32_t ci = fractal_view_current.cy + (y - fractal_height / 2) * fractal_view_current.step;
+    int32_t cr = fractal_view_current.cx - (fractal_width / 2) * fractal_view_current.step;
+
+    for (int x = skip ? block : 0; x < fractal_width; x += skip ? block * 2 : block)
+    {
+        int k = fractal_iterate(cr + x * fractal_view_current.step, ci, fractal_view_current.max_iter, &used);
+        unsigned char c = colour_base + (k >= fractal_view_current.max_iter ? fractal_palette[0] : fractal_palette[1 + k % 15]);
+        int w = x + block > fractal_width ? fractal_width - x : block;
+        for (int i = 0; i < h; i++)
+        {
+            memset(&fractal_dst[fractal_width * screen_row(y + i) + x], c, w);
+        }
+    }
+    return used;
+}
+
+// Draw rows of the current pass on one core until the budget runs out
+// - core: The core, which draws every other row
+// - budget: Iterations to spend; the row in progress is always finished
+// Returns
+// - Iterations used
+//
+static uint32_t __not_in_flash_func(fractal_run)(int core, uint32_t budget)
+{
+    uint32_t used = 0;
+    while (used < budget && fractal_row[core] < fractal_height)
+    {
+        used += fractal_draw_row(fractal_row[core]);
+        fractal_row[core] += fractal_block * 2;
+    }
+    return used;
+}
+
+// The core 1 job
+// - budget: Iterations to spend
+// Returns
+// - Iterations used
+//
+static uint32_t fractal_core1_job(uint32_t budget)
+{
+    return fractal_run(1, budget);
+}
+
+// Start the core 1 worker; core 1 must not be running anything else
+//
+void initialise_fractal(void)
+{
+    initialise_worker();
+}
+
+// Start drawing a new view; it is drawn into the front buffer so the passes can be seen, so
+// call this again after a mode change
+// - v: The view, which is copied
+//
+void fractal_start(const struct fractal_view *v)
+{
+    fractal_view_current = *v;
+    fractal_dst = screen_bitmap;
+    fractal_width = screenWidth;
+    fractal_height = screenHeight;
+    fractal_block = FRACTAL_BLOCK;
+    fractal_row[0] = 0;
+    fractal_row[1] = FRACTAL_BLOCK;
+}
+
+// Carry on drawing
+// - budget: Iterations to spend this call, split between the cores
+// Returns
+// - true once the picture is finished
+//
+bool fractal_update(uint32_t budget)
+{
+    if (fractal_block == 0 || fractal_dst == NULL)
+    {
+        return true;
+    }
+    worker_start(fractal_core1_job, budget / 2);
+    fractal_run(0, budget / 2);
+    worker_wait();
+    if (fractal_row[0] >= fractal_height && fractal_row[1] >= fractal_height)
+    {
+        fractal_block >>= 1; // On to the next pass
+        fractal_row[0] = 0;
+        fractal_row[1] = fractal_block;
+    }
+    return fractal_block == 0;
+}
+
+// Check whether the picture is finished
+//
+bool fractal_done(void)
+{
+    return fractal_block == 0;
+}
@@ -0,0 +1,42 @@
+//
+// Title:	        Pico-mposite Fractal Renderer
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Mandelbrot set in Q4.28 fixed point, shared between both cores and refined progressively
+// so a frame budget keeps zooming responsive
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FRACTAL_FRAC 28                                         // Fraction bits in the Q4.28 coordinates
+#define FRACTAL_FIX(f) ((int32_t)((f) * (1 << FRACTAL_FRAC)))   // Q4.28 from a constant
+#define FRACTAL_BLOCK 8                                         // Block size of the first, coarsest pass
+
+struct fractal_view
+{
+    int32_t cx, cy; // Point at the centre of the screen, Q4.28
+    int32_t step;   // Distance between pixels, Q4.28
+    int max_iter;   // Iteration limit; points that reach it are inside the set
+};
+
+extern unsigned char fractal_palette[16];
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void initialise_fractal(void);
+    void fractal_start(const struct fractal_view *view);
+    bool fractal_update(uint32_t budget);
+    bool fractal_done(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -12,6 +12,9 @@
 // 08/07/2022:      Optimised filled circle drawing
 // 20/02/2022:      Added scroll_up, bitmap now initialised in cvideo.c
 // 02/03/2022:      Added blit
+// 18/10/2026:      scroll_up now uses the hardware scroll, print_char honours it
+//                  Added fillTriangle and drawTriangle
+//                  Public functions are timed by the profiler when opt_profile is set
 #include <Arduino.h>
 #include <math.h>
 
@@ -26,6 +29,7 @@
 
 #include "graphics.h"
 #include "glcdfont.h"
+#include "profile.h"
 
 #include <math.h> //para el cos y sin
 
@@ -44,10 +48,37 @@ char textcolor, textbgcolor, wrap;
 // - c: Background colour to fill screen with
 //
 void clearScreen(unsigned char c) {  //borra mas rapido esta version
+  PROFILE(clearScreen);
   unsigned int* p = (unsigned int*)screen_bitmap_next;
   for (int i = 0; i < screenHeight * screenWidth / 4; i++) {
     p[i] = 0;
   }
+  PROFILE_PIXELS(screenHeight * screenWidth);
+}
+
+// Scroll the screen up
+// The rows are not moved; the hardware scroll is advanced and the rows that wrap round
+// to the bottom of the screen are cleared
+// - c: Background colour to fill blank area with
+// - rows: Number of pixel rows to scroll up by
+//
+void scroll_up(unsigned char c, int rows)
+{
+    PROFILE(scroll_up);
+    if (rows <= 0)
+    {
+        return;
+    }
+    if (rows > screenHeight)
+    {
+        rows = screenHeight;
+    }
+    set_scroll(scroll_x, scroll_y + rows);
+    for (int i = screenHeight - rows; i < screenHeight; i++)
+    {
+        memset(&screen_bitmap[screenWidth * screen_row(i)], colour_base + c, screenWidth);
+    }
+    PROFILE_PIXELS(rows * screenWidth);
 }
 
 // Print a character
@@ -59,22 +90,23 @@ void clearScreen(unsigned char c) {  //borra mas rapido esta version
 //
 void print_char(int x, int y, int c, unsigned char bc, unsigned char fc)
 {
+    PROFILE(print_char);
     int char_index;
     unsigned char *ptr;
 
     if (c >= 32 && c < 128)
     {
         char_index = (c - 32) * 8;
-        ptr = &screen_bitmap[screenWidth * y + x + 7];
         for (int row = 0; row < 8; row++)
         {
+            ptr = &screen_bitmap[screenWidth * screen_row(y + row) + x + 7]; // Rows follow the hardware scroll
             unsigned char data = charset[char_index + row];
             for (int bit = 0; bit < 8; bit++)
             {
                 *(ptr - bit) = data & 1 << bit ? colour_base + fc : colour_base + bc;
             }
-            ptr += screenWidth;
         }
+        PROFILE_PIXELS(64);
     }
 }
 
@@ -87,6 +119,7 @@ void print_char(int x, int y, int c, unsigned char bc, unsigned char fc)
 //
 void print_string(int x, int y, char *s, unsigned char bc, unsigned char fc)
 {
+    PROFILE(print_string);
     for (int i = 0; i < strlen(s); i++)
     {
         print_char(x + i * 8, y, s[i], bc, fc);
@@ -100,14 +133,17 @@ void print_string(int x, int y, char *s, unsigned char bc, unsigned char fc)
 //
 void drawPixel(short x, short y, unsigned char c)
 {
+    PROFILE(drawPixel);
     if (x >= 0 && x < screenWidth && y >= 0 && y < screenHeight)
     {
         screen_bitmap_next[screenWidth * y + x] = colour_base + c;
+        PROFILE_PIXELS(1);
     }
 }
 
 unsigned char getPixel(short x, short y)
 {
+    PROFILE(getPixel);
     if (x >= 0 && x < screenWidth && y >= 0 && y < screenHeight)
         return screen_bitmap_next[y * screenWidth + x];
     return 0;
@@ -115,6 +151,7 @@ unsigned char getPixel(short x, short y)
 
 void drawVLine(short x, short y, short h, unsigned char c)
 {
+    PROFILE(drawVLine);
     if (x < 0 || x >= screenWidth || h <= 0)
         return;
     if (y < 0)
@@ -130,10 +167,12 @@ void drawVLine(short x, short y, short h, unsigned char c)
     {
         screen_bitmap_next[(y + i) * screenWidth + x-1] = colour_base + c;
     }
+    PROFILE_PIXELS(h);
 }
 
 void drawHLine(short x, short y, short w, unsigned char c)
 {
+    PROFILE(drawHLine);
     if (y < 0 || y >= screenHeight || w <= 0)
         return;
     if (x < 0)
@@ -149,15 +188,18 @@ void drawHLine(short x, short y, short w, unsigned char c)
     {
         screen_bitmap_next[y * screenWidth + x + i] = colour_base + c;
     }
+    PROFILE_PIXELS(w);
 }
 
 void drawRectCenter(short x, short y, short w, short h, char c)
 {
+    PROFILE(drawRectCenter);
     drawRect(x - (w >> 1), y - (h >> 1), w, h, c);
 }
 
 void drawLineThickness(short x0, short y0, short x1, short y1, unsigned char c, short thickness)
 {
+    PROFILE(drawLineThickness);
     if (thickness <= 1)
     {
         drawLine(x0, y0, x1, y1, c);
@@ -193,6 +235,7 @@ void drawLineThickness(short x0, short y0, short x1, short y1, unsigned char c,
 
 void fillRect(short x, short y, short w, short h, char c)
 {
+    PROFILE(fillRect);
     if (w < 0 || h < 0)
         return;
     if (x < 0)
@@ -215,6 +258,7 @@ void fillRect(short x, short y, short w, short h, char c)
     {
         memset(&screen_bitmap_next[(y + j) * screenWidth + x], colour_base + c, w);
     }
+    PROFILE_PIXELS(w * h);
 }
 
 // For drawLine
@@ -228,6 +272,7 @@ void swapNumb(short *a, short *b)
 // Bresenham's algorithm - thx wikipedia and thx Bruce!
 void drawLine(short x0, short y0, short x1, short y1, char color)
 {
+    PROFILE(drawLine);
     short steep = abs(y1 - y0) > abs(x1 - x0);
     if (steep)
     {
@@ -275,6 +320,7 @@ void drawLine(short x0, short y0, short x1, short y1, char color)
 
 void drawRect(short x, short y, short w, short h, char color)
 {
+    PROFILE(drawRect);
     if (w < 0 || h < 0)
         return;
     drawHLine(x, y, w, color);
@@ -283,8 +329,69 @@ void drawRect(short x, short y, short w, short h, char color)
     drawVLine(x + w , y, h, color);
 }
 
+// Draw a triangle outline
+// - x0, y0, x1, y1, x2, y2: The corners
+// - color: Line colour
+//
+void drawTriangle(short x0, short y0, short x1, short y1, short x2, short y2, char color)
+{
+    PROFILE(drawTriangle);
+    drawLine(x0, y0, x1, y1, color);
+    drawLine(x1, y1, x2, y2, color);
+    drawLine(x2, y2, x0, y0, color);
+}
+
+// Fill a triangle
+// Rows from the top corner down to, but not including, the bottom corner are filled, and each span
+// runs up to but not including its right edge, so triangles sharing an edge don't overlap
+// - x0, y0, x1, y1, x2, y2: The corners, in any order
+// - color: Fill colour
+//
+void fillTriangle(short x0, short y0, short x1, short y1, short x2, short y2, char color)
+{
+    PROFILE(fillTriangle);
+    if (y0 > y1)
+    {
+        swapNumb(&y0, &y1);
+        swapNumb(&x0, &x1);
+    }
+    if (y1 > y2)
+    {
+        swapNumb(&y1, &y2);
+        swapNumb(&x1, &x2);
+    }
+    if (y0 > y1)
+    {
+        swapNumb(&y0, &y1);
+        swapNumb(&x0, &x1);
+    }
+    int ys = y0 < 0 ? 0 : y0;
+    int ye = y2 > screenHeight ? screenHeight : y2;
+    for (int y = ys; y < ye; y++)
+    {
+        int a = x0 + (x2 - x0) * (y - y0) / (y2 - y0); // The long edge
+        int b = y < y1 ? x0 + (x1 - x0) * (y - y0) / (y1 - y0) : x1 + (x2 - x1) * (y - y1) / (y2 - y1);
+        if (a > b)
+        {
+            int t = a;
+            a = b;
+            b = t;
+        }
+        if (a < 0)
+            a = 0;
+        if (b > screenWidth)
+            b = screenWidth;
+        if (a < b)
+        {
+            memset(&screen_bitmap_next[y * screenWidth + a], colour_base + color, b - a);
+            PROFILE_PIXELS(b - a);
+        }
+    }
+}
+
 void drawRectTransparency(short x, short y, short w, short h, char color, uint8_t thickness, int transparency)
 {
+    PROFILE(drawRectTransparency);
     if (w < 0 || h < 0)
         return;
     short halfWidth = (w >> 1);
@@ -388,11 +495,13 @@ void drawRectTransparency(short x, short y, short w, short h, char color, uint8_
 
 void drawRectCenterThickness(short x, short y, short w, short h, char color, short thickness)
 {
+    PROFILE(drawRectCenterThickness);
     drawRectThickness(x - (w >> 1), y - (h >> 1), w, h, color, thickness);
 }
 
 void drawCircleHelper(short x0, short y0, short r, unsigned char cornername, char color)
 {
+    PROFILE(drawCircleHelper);
     // Helper function for drawing circles and circular objects
     short f = 1 - r;
     short ddF_x = 1;
@@ -436,6 +545,7 @@ void drawCircleHelper(short x0, short y0, short r, unsigned char cornername, cha
 
 void drawCircle(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency)
 {
+    PROFILE(drawCircle);
     if (transparency <= 0)
         return;
     transparency = constrain(transparency, 0, 255);
@@ -592,6 +702,7 @@ void drawCircle(short x0, short y0, short w, short h, char color, uint8_t thickn
 
 void drawCircleRotated(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency, short angleDeg)
 {
+    PROFILE(drawCircleRotated);
     if (transparency <= 0)
         return;
     transparency = constrain(transparency, 0, 255);
@@ -850,6 +961,7 @@ void drawCircleRotated(short x0, short y0, short w, short h, char color, uint8_t
 
 void fillCircle(short x0, short y0, short r, char color)
 {
+    PROFILE(fillCircle);
     /* Draw a filled circle with center (x0,y0) and radius r, with given color
       Parameters:
            x0: x-coordinate of center of circle. The top-left of the screen
@@ -866,6 +978,7 @@ void fillCircle(short x0, short y0, short r, char color)
 
 void filledElipsisTransparency(short x0, short y0, short w, short h, char color, int transparency)
 {
+    PROFILE(filledElipsisTransparency);
     if (transparency == 0)
         return;
 
@@ -899,6 +1012,7 @@ void filledElipsisTransparency(short x0, short y0, short w, short h, char color,
 
 void filledElipsisRotated(short x0, short y0, short w, short h, char color, int transparency, short angleDeg)
 {
+    PROFILE(filledElipsisRotated);
 
     if (transparency == 0)
         return;
@@ -1023,6 +1137,7 @@ void filledElipsisRotated(short x0, short y0, short w, short h, char color, int
 // Draw a rounded rectangle
 void drawRoundRect(short x, short y, short w, short h, short r, char color)
 {
+    PROFILE(drawRoundRect);
     /* Draw a rounded rectangle outline with top left vertex (x,y), width w,
       height h and radius of curvature r at given color
       Parameters:
@@ -1050,6 +1165,7 @@ void drawRoundRect(short x, short y, short w, short h, short r, char color)
 // Fill a rounded rectangle
 void fillRoundRect(short x, short y, short w, short h, short r, char color)
 {
+    PROFILE(fillRoundRect);
     // smarter version
     fillRect(x + r, y, w - 2 * r, h, color);
 
@@ -1060,11 +1176,13 @@ void fillRoundRect(short x, short y, short w, short h, short r, char color)
 
 void fillRectCenter(short x, short y, short w, short h, char color)
 {
+    PROFILE(fillRectCenter);
     fillRect(x - (w >> 1), y - (h >> 1), w, h, color);
 }
 
 void fillRectTransparency(short x, short y, short w, short h, char color, int transparency)
 {
+    PROFILE(fillRectTransparency);
     if (w < 0 || h < 0)
         return;
     if (transparency <= 0)
@@ -1095,6 +1213,7 @@ void fillRectTransparency(short x, short y, short w, short h, char color, int tr
 
 void drawFillRectRotated(short x, short y, short w, short h, char color, int transparency, short angleDeg)
 {
+    PROFILE(drawFillRectRotated);
     if (w < 0 || h < 0)
         return;
     if (transparency <= 0)
@@ -1183,6 +1302,7 @@ void drawFillRectRotated(short x, short y, short w, short h, char color, int tra
 
 void drawRectThickness(short x, short y, short w, short h, char color, short thickness)
 {
+    PROFILE(drawRectThickness);
     if (w < 0 || h < 0)
         return;
 
@@ -1221,6 +1341,7 @@ void drawRectThickness(short x, short y, short w, short h, char color, short thi
 
 void drawRectRotated(short x, short y, short w, short h, char color, uint8_t thickness, int transparency, short angleDeg)
 {
+    PROFILE(drawRectRotated);
     if (w <= 0 || h <= 0 || transparency <= 0)
         return;
     transparency = constrain(transparency, 0, 255);
@@ -1297,11 +1418,13 @@ void drawRectRotated(short x, short y, short w, short h, char color, uint8_t thi
 // Draw a character
 void drawChar(short x, short y, unsigned char c, char color, char bg, unsigned char size, short transparency)
 {
+    PROFILE(drawChar);
     drawCharCustomSize(x, y, c, color, bg, size, size, transparency);
 }
 
 void drawCharCustomSize(short x, short y, unsigned char c, char color, char bg, short widthSize, short heightSize, short transparency)
 {
+    PROFILE(drawCharCustomSize);
     if (transparency <= 0)
         return;
     if (transparency > 255)
@@ -1384,6 +1507,7 @@ void drawCharCustomSize(short x, short y, unsigned char c, char color, char bg,
 
 void setTextCursor(short x, short y)
 {
+    PROFILE(setTextCursor);
     /* Set cursor for text to be printed
       Parameters:
            x = x-coordinate of top-left of text starting
@@ -1396,6 +1520,7 @@ void setTextCursor(short x, short y)
 
 void setTextSize(unsigned char s)
 {
+    PROFILE(setTextSize);
     /*Set size of text to be displayed
       Parameters:
            s = text size (1 being smallest)
@@ -1406,6 +1531,7 @@ void setTextSize(unsigned char s)
 
 void setTextColor(char c)
 {
+    PROFILE(setTextColor);
     // For 'transparent' background, we'll set the bg
     // to the same as fg instead of using a flag
     textcolor = textbgcolor = c;
@@ -1413,6 +1539,7 @@ void setTextColor(char c)
 
 void setTextColor2(char c, char b)
 {
+    PROFILE(setTextColor2);
     /* Set color of text to be displayed
       Parameters:
            c = 16-bit color of text
@@ -1424,11 +1551,13 @@ void setTextColor2(char c, char b)
 
 void setTextWrap(char w)
 {
+    PROFILE(setTextWrap);
     wrap = w;
 }
 
 void tft_write(unsigned char c)
 {
+    PROFILE(tft_write);
 
     if (c == '\n')
     {
@@ -1461,6 +1590,7 @@ void tft_write(unsigned char c)
 
 void writeString(char *str)
 {
+    PROFILE(writeString);
     /* Print text onto screen
       Call tft_setTextCursor(), tft_setTextColor(), tft_setTextSize()
        as necessary before printing
@@ -1479,6 +1609,7 @@ void drawImage(int xPosition, int yPosition,
                int color, int bgColor,
                bool doItFast, int transparency)
 {
+    PROFILE(drawImage);
     if (transparency <= 0)
         return;
     if (transparency > 255)
@@ -1652,6 +1783,7 @@ void drawImage(int xPosition, int yPosition,
 
 void drawStar(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency)
 {
+    PROFILE(drawStar);
     if (transparency <= 0)
         return;
     transparency = constrain(transparency, 0, 255);
@@ -1757,6 +1889,7 @@ void drawPixelWithTransparency(short px, short py, short color, short transparen
 
 void drawPussy(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency)
 {
+    PROFILE(drawPussy);
     if (transparency <= 0)
         return;
     transparency = constrain(transparency, 0, 255);
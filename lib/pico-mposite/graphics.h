@@ -8,6 +8,8 @@
 // 07/02/2022:      Added support for filled primitives
 // 20/02/2022:      Added scroll_up, bitmap now initialised in cvideo.c
 // 02/03/2022:      Added blit
+// 18/10/2026:      Added scroll_up back using the hardware scroll
+//                  Added fillTriangle and drawTriangle
 
 #pragma once
 
@@ -35,6 +37,7 @@ extern "C" {
 #endif
 
 void clearScreen(unsigned char c);
+void scroll_up(unsigned char c, int rows);
 
 void print_char(int x, int y, int c, unsigned char bc, unsigned char fc);
 void print_string(int x, int y, char *s, unsigned char bc, unsigned char fc);
@@ -50,6 +53,8 @@ void drawRectThickness(short x, short y, short w, short h, char color, short thi
 void drawRectCenter(short x, short y, short w, short h, char color);
 void drawRectCenterThickness(short x, short y, short w, short h, char color, short thickness);
 void drawRectRotated(short x, short y, short w, short h, char color, uint8_t thickness, int transparency, short angleDeg);
+void drawTriangle(short x0, short y0, short x1, short y1, short x2, short y2, char color);
+void fillTriangle(short x0, short y0, short x1, short y1, short x2, short y2, char color);
 void drawRectTransparency(short x, short y, short w, short h, char color, uint8_t thickness, int transparency);
 void drawCircleHelper(short x0, short y0, short r, unsigned char cornername, char color);
 void drawCircle(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency);
@@ -0,0 +1,239 @@
+//
+// Title:	        Pico-mposite Life
+// Description:		Bit parallel Game of Life
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Cells are packed 32 to a word, leftmost cell in bit 0, and the grid wraps at the edges. A
+// generation works a word at a time: the eight neighbour words are formed by shifting in the bits
+// from the words either side, then added with bitwise adders so each bit position holds its own
+// count (SWAR). Only counts of 2 and 3 matter, so anything past 3 just sets a sticky 4s bit. The
+// top half of the grid is done on core 0 and the bottom half on core 1, and drawing is split the
+// same way, expanding four cells at a time into a word of pixels
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "life.h"
+#include "worker.h"
+
+#define LIFE_MAX_WORDS (LIFE_MAX_WIDTH / 32 * LIFE_MAX_HEIGHT)
+
+uint32_t life_grid[2][LIFE_MAX_WORDS]; // Current and next generations
+uint32_t *life_src = life_grid[0];     // Current generation
+uint32_t *life_dst = life_grid[1];
+int life_width;
+int life_height;
+int life_words; // Words per row
+
+int life_draw_x; // Where life_draw is drawing to, for the core 1 job
+int life_draw_y;
+uint32_t life_fg; // Colours repeated across a word
+uint32_t life_bg;
+
+// Masks to expand a nibble of cells into four pixels; the cell in bit 0 is the leftmost pixel, in the low byte
+//
+static const uint32_t life_mask[16] = {
+    0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff,
+    0x00ff0000, 0x00ff00ff, 0x00ffff00, 0x00ffffff,
+    0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
+    0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff};
+
+// Set the grid size and clear it
+// - width: Width in cells, a multiple of 32
+// - height: Height in cells
+// Returns
+// - 0 on success, -1 if the size is not supported
+//
+int life_init(int width, int height)
+{
+    if (width <= 0 || width > LIFE_MAX_WIDTH || (width & 31) || height <= 0 || height > LIFE_MAX_HEIGHT)
+    {
+        return -1;
+    }
+    life_width = width;
+    life_height = height;
+    life_words = width / 32;
+    life_clear();
+    return 0;
+}
+
+// Kill every cell
+//
+void life_clear(void)
+{
+    memset(life_src, 0, life_words * life_height * sizeof(uint32_t));
+}
+
+// Fill the grid with random cells
+// - seed: Random seed
+// - density: Chance of each cell being alive, out of 256
+//
+void life_randomise(uint32_t seed, int density)
+{
+    uint32_t r = seed ? seed : 1;
+    for (int i = 0; i < life_words * life_height; i++)
+    {
+        uint32_t w = 0;
+        for (int b = 0; b < 32; b++)
+        {
+            r ^= r << 13; // xorshift32
+            r ^= r >> 17;
+            r ^= r << 5;
+            w |= (uint32_t)((r & 255) < (uint32_t)density) << b;
+        }
+        life_src[i] = w;
+    }
+}
+
+// Set a cell
+// - x, y: Position in the grid
+// - alive: State
+//
+void life_set(int x, int y, bool alive)
+{
+    if (x >= 0 && x < life_width && y >= 0 && y < life_height)
+    {
+        uint32_t *w = &life_src[y * life_words + (x >> 5)];
+        *w = alive ? *w | 1u << (x & 31) : *w & ~(1u << (x & 31));
+    }
+}
+
+// Get a cell
+// - x, y: Position in the grid
+// Returns
+// - Whether it is alive; false off the grid
+//
+bool life_get(int x, int y)
+{
+    if (x >= 0 && x < life_width && y >= 0 && y < life_height)
+    {
+        return (life_src[y * life_words + (x >> 5)] >> (x & 31)) & 1;
+    }
+    return false;
+}
+
+// Add a word of one bit values to a bit sliced count
+// - v: The values
+// - s: Count bits; 1s, 2s, and a sticky bit for 4 or more
+//
+static inline void life_add(uint32_t v, uint32_t *s)
+{
+    uint32_t c0 = s[0] & v;
+    s[0] ^= v;
+    s[2] |= s[1] & c0;
+    s[1] ^= c0;
+}
+
+// Work out the next generation of a band of rows
+// - y0, y1: First row and the row after the last
+//
+static void __not_in_flash_func(life_band)(int y0, int y1)
+{
+    int words = life_words;
+    for (int y = y0; y < y1; y++)
+    {
+        const uint32_t *up = &life_src[(y == 0 ? life_height - 1 : y - 1) * words];
+        const uint32_t *mid = &life_src[y * words];
+        const uint32_t *down = &life_src[(y == life_height - 1 ? 0 : y + 1) * words];
+        uint32_t *out = &life_dst[y * words];
+
+        uint32_t ul = up[words - 1], ml = mid[words - 1], dl = down[words - 1]; // Words to the left
+        uint32_t uc = up[0], mc = mid[0], dc = down[0];                         // This word
+        for (int i = 0; i < words; i++)
+        {
+            int n = i + 1 < words ? i + 1 : 0;
+            uint32_t ur = up[n], mr = mid[n], dr = down[n]; // Words to the right
+            uint32_t s[3] = {0, 0, 0};
+
+            life_add((uc << 1) | (ul >> 31), s); // Neighbours to the left
+            life_add(uc, s);
+            life_add((uc >> 1) | (ur << 31), s); // And to the right
+            life_add((mc << 1) | (ml >> 31), s);
+            life_add((mc >> 1) | (mr << 31), s);
+            life_add((dc << 1) | (dl >> 31), s);
+            life_add(dc, s);
+            life_add((dc >> 1) | (dr << 31), s);
+            out[i] = ~s[2] & s[1] & (s[0] | mc); // 3, or 2 and alive
+
+            ul = uc, ml = mc, dl = dc;
+            uc = ur, mc = mr, dc = dr;
+        }
+    }
+}
+
+// Draw a band of rows into screen_bitmap_next
+// - y0, y1: First row and the row after the last
+//
+static void __not_in_flash_func(life_draw_band)(int y0, int y1)
+{
+    uint32_t fg = life_fg, bg = life_bg;
+    for (int y = y0; y < y1; y++)
+    {
+        const uint32_t *src = &life_src[y * life_words];
+        uint32_t *p = (uint32_t *)&screen_bitmap_next[(life_draw_y + y) * screenWidth + life_draw_x];
+        for (int i = 0; i < life_words; i++)
+        {
+            uint32_t w = src[i];
+            for (int j = 0; j < 8; j++, w >>= 4)
+            {
+                uint32_t m = life_mask[w & 15];
+                *p++ = (fg & m) | (bg & ~m);
+            }
+        }
+    }
+}
+
+// The core 1 jobs; they do the bottom half of the grid
+//
+static uint32_t life_step_job(uint32_t arg)
+{
+    life_band(life_height / 2, life_height);
+    return 0;
+}
+
+static uint32_t life_draw_job(uint32_t arg)
+{
+    life_draw_band(arg, life_height);
+    return 0;
+}
+
+// Move on a generation; uses core 1 if the worker has been started
+//
+void life_step(void)
+{
+    worker_start(life_step_job, 0);
+    life_band(0, life_height / 2);
+    worker_wait();
+
+    uint32_t *t = life_src;
+    life_src = life_dst;
+    life_dst = t;
+}
+
+// Draw the grid into screen_bitmap_next, a pixel per cell
+// - x, y: Screen position of the top left cell; x must be a multiple of 4 and the grid must fit on screen
+// - fg, bg: Colours of live and dead cells
+//
+void life_draw(int x, int y, unsigned char fg, unsigned char bg)
+{
+    if (x < 0 || (x & 3) || x + life_width > screenWidth || y < 0 || y + life_height > screenHeight)
+    {
+        return;
+    }
+    life_draw_x = x;
+    life_draw_y = y;
+    life_fg = (colour_base + fg) * 0x01010101u;
+    life_bg = (colour_base + bg) * 0x01010101u;
+    worker_start(life_draw_job, life_height / 2);
+    life_draw_band(0, life_height / 2);
+    worker_wait();
+}
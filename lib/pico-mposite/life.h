@@ -0,0 +1,39 @@
+//
+// Title:	        Pico-mposite Life
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Conway's Game of Life on a packed grid of one bit per cell, on both cores
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#define LIFE_MAX_WIDTH opt_max_width // Largest grid, in cells; the width is a multiple of 32
+#define LIFE_MAX_HEIGHT 240
+
+extern int life_width;
+extern int life_height;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int life_init(int width, int height);
+    void life_clear(void);
+    void life_randomise(uint32_t seed, int density);
+    void life_set(int x, int y, bool alive);
+    bool life_get(int x, int y);
+    void life_step(void);
+    void life_draw(int x, int y, unsigned char fg, unsigned char bg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,179 @@
+//
+// Title:	        Pico-mposite 3D Meshes
+// Description:		Fixed point mesh transform and painter's sort
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// The rotation matrix is built once per mesh from the 1024 scaled sine tables and held in Q16,
+// so each vertex costs nine multiplies and a divide for the projection. Vertices are transformed
+// in one pass into arrays of screen coordinates; faces are then culled against their winding and
+// sorted back to front on the sum of their corner depths with a two pass radix sort
+//
+// Modinfo:
+// 18/10/2026:      Faces can go to the span buffer instead of the painter's sort
+#include <Arduino.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "mesh3d.h"
+#include "sbuffer.h"
+
+#define MESH_MAX_SCREEN 8000 // Projected coordinates are clamped to this, so the culling test can't overflow
+
+short mesh_sx[MESH_MAX_VERTICES]; // Projected vertices
+short mesh_sy[MESH_MAX_VERTICES];
+int32_t mesh_vz[MESH_MAX_VERTICES]; // View space depth, or 0 if the vertex is too close to project
+
+uint32_t mesh_order[MESH_MAX_FACES]; // Depth key in the top 16 bits, face index in the bottom 16
+uint32_t mesh_sorted[MESH_MAX_FACES];
+
+// Build a rotation matrix; rotates about x, then y, then z, and clears the translation
+// - m: Matrix to fill
+// - ax, ay, az: Angles in degrees
+//
+void mesh_rotation(struct mesh_matrix *m, int ax, int ay, int az)
+{
+    ax %= 360;
+    ay %= 360;
+    az %= 360;
+    int32_t sx = sinTable[ax < 0 ? ax + 360 : ax], cx = cosTable[ax < 0 ? ax + 360 : ax]; // Q10
+    int32_t sy = sinTable[ay < 0 ? ay + 360 : ay], cy = cosTable[ay < 0 ? ay + 360 : ay];
+    int32_t sz = sinTable[az < 0 ? az + 360 : az], cz = cosTable[az < 0 ? az + 360 : az];
+    int32_t syx = (sy * sx) >> 10;
+    int32_t syc = (sy * cx) >> 10;
+
+    m->m[0][0] = (cz * cy) >> 4; // Q20 to Q16
+    m->m[0][1] = (cz * syx - sz * cx) >> 4;
+    m->m[0][2] = (cz * syc + sz * sx) >> 4;
+    m->m[1][0] = (sz * cy) >> 4;
+    m->m[1][1] = (sz * syx + cz * cx) >> 4;
+    m->m[1][2] = (sz * syc - cz * sx) >> 4;
+    m->m[2][0] = -sy * 64;
+    m->m[2][1] = (cy * sx) >> 4;
+    m->m[2][2] = (cy * cx) >> 4;
+    m->t[0] = m->t[1] = m->t[2] = 0;
+}
+
+// Transform and project the vertices
+//
+static void mesh_transform(const struct mesh *mesh, const struct mesh_matrix *m, const struct mesh_camera *camera)
+{
+    for (int i = 0; i < mesh->vertex_count; i++)
+    {
+        int32_t x = mesh->x[i], y = mesh->y[i], z = mesh->z[i];
+        int32_t vz = ((m->m[2][0] * x + m->m[2][1] * y + m->m[2][2] * z) >> 16) + m->t[2];
+        if (vz < MESH_NEAR)
+        {
+            mesh_vz[i] = 0;
+            continue;
+        }
+        int32_t vx = ((m->m[0][0] * x + m->m[0][1] * y + m->m[0][2] * z) >> 16) + m->t[0];
+        int32_t vy = ((m->m[1][0] * x + m->m[1][1] * y + m->m[1][2] * z) >> 16) + m->t[1];
+        vx = camera->cx + vx * camera->focal / vz;
+        vy = camera->cy + vy * camera->focal / vz;
+        mesh_sx[i] = vx < -MESH_MAX_SCREEN ? -MESH_MAX_SCREEN : vx > MESH_MAX_SCREEN ? MESH_MAX_SCREEN : vx;
+        mesh_sy[i] = vy < -MESH_MAX_SCREEN ? -MESH_MAX_SCREEN : vy > MESH_MAX_SCREEN ? MESH_MAX_SCREEN : vy;
+        mesh_vz[i] = vz;
+    }
+}
+
+// Sort the visible faces back to front
+// - count: Number of entries in mesh_order
+// Returns
+// - The sorted entries
+//
+static uint32_t *mesh_sort(int count)
+{
+    uint32_t *src = mesh_order, *dst = mesh_sorted;
+    for (int shift = 16; shift < 32; shift += 8)
+    {
+        int start[256] = {0};
+        for (int i = 0; i < count; i++)
+        {
+            start[(src[i] >> shift) & 255]++;
+        }
+        for (int i = 0, total = 0; i < 256; i++)
+        {
+            int n = start[i];
+            start[i] = total;
+            total += n;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            dst[start[(src[i] >> shift) & 255]++] = src[i];
+        }
+        uint32_t *t = src;
+        src = dst;
+        dst = t;
+    }
+    return src;
+}
+
+// Draw a mesh
+// - mesh: The mesh
+// - m: Model to view transform
+// - camera: The projection
+// - flags: MESH_FILLED and/or MESH_WIREFRAME, or MESH_SBUFFER to add the filled faces to the span
+//          buffer; the scene is then drawn by sbuf_flush
+// Returns
+// - Number of faces drawn, or -1 if the mesh is too big
+//
+int mesh_draw(const struct mesh *mesh, const struct mesh_matrix *m, const struct mesh_camera *camera, int flags)
+{
+    if (mesh->vertex_count > MESH_MAX_VERTICES || mesh->face_count > MESH_MAX_FACES)
+    {
+        return -1;
+    }
+    mesh_transform(mesh, m, camera);
+
+    int count = 0;
+    const unsigned short *f = mesh->faces;
+    for (int i = 0; i < mesh->face_count; i++, f += 3)
+    {
+        int a = f[0], b = f[1], c = f[2];
+        if (mesh_vz[a] == 0 || mesh_vz[b] == 0 || mesh_vz[c] == 0)
+        {
+            continue; // Too close to project
+        }
+        int area = mesh_sx[a] * (mesh_sy[b] - mesh_sy[c]) + mesh_sx[b] * (mesh_sy[c] - mesh_sy[a]) + mesh_sx[c] * (mesh_sy[a] - mesh_sy[b]);
+        if (area <= 0)
+        {
+            continue; // Facing away
+        }
+        if (flags & MESH_SBUFFER)
+        {
+            sbuf_triangle(mesh_sx[a], mesh_sy[a], (1 << 24) / mesh_vz[a], mesh_sx[b], mesh_sy[b], (1 << 24) / mesh_vz[b], mesh_sx[c], mesh_sy[c], (1 << 24) / mesh_vz[c], mesh->colours[i]);
+            count++;
+            continue; // The span buffer sorts out what is in front
+        }
+        uint32_t depth = (mesh_vz[a] + mesh_vz[b] + mesh_vz[c]) >> 2;
+        depth = depth > 0xffff ? 0 : 0xffff - depth; // Furthest first
+        mesh_order[count++] = depth << 16 | i;
+    }
+
+    if (flags & MESH_SBUFFER)
+    {
+        return count;
+    }
+    uint32_t *order = mesh_sort(count);
+    for (int i = 0; i < count; i++)
+    {
+        int face = order[i] & 0xffff;
+        f = &mesh->faces[face * 3];
+        unsigned char colour = mesh->colours[face];
+        if (flags & MESH_FILLED)
+        {
+            fillTriangle(mesh_sx[f[0]], mesh_sy[f[0]], mesh_sx[f[1]], mesh_sy[f[1]], mesh_sx[f[2]], mesh_sy[f[2]], colour);
+        }
+        if (flags & MESH_WIREFRAME)
+        {
+            drawTriangle(mesh_sx[f[0]], mesh_sy[f[0]], mesh_sx[f[1]], mesh_sy[f[1]], mesh_sx[f[2]], mesh_sy[f[2]], colour);
+        }
+    }
+    return count;
+}
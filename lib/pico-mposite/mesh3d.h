@@ -0,0 +1,58 @@
+//
+// Title:	        Pico-mposite 3D Meshes
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Fixed point transform, projection, back face culling and painter's sort for triangle meshes
+//
+// Modinfo:
+// 18/10/2026:      Added MESH_SBUFFER
+
+#pragma once
+
+#include <stdint.h>
+
+#define MESH_MAX_VERTICES 512 // Largest mesh mesh_draw can transform
+#define MESH_MAX_FACES 1024
+#define MESH_NEAR 16          // Faces with a corner closer than this are not drawn
+#define MESH_MAX_COORD 8191   // Model coordinates are within +/- this, so the Q16 transform fits in 32 bits
+
+#define MESH_FILLED 0x01    // Fill the faces
+#define MESH_WIREFRAME 0x02 // Outline the faces
+#define MESH_SBUFFER 0x04   // Add the faces to the span buffer rather than sorting and drawing them
+
+struct mesh
+{
+    int vertex_count;
+    const short *x;               // Vertex coordinates, one array per axis
+    const short *y;
+    const short *z;
+    int face_count;
+    const unsigned short *faces;  // Three vertex indexes per face, clockwise on screen when facing the viewer
+    const unsigned char *colours; // Colour of each face
+};
+
+struct mesh_matrix
+{
+    int32_t m[3][3]; // Rotation, Q16
+    int32_t t[3];    // Translation, in model units; z is the distance from the viewer
+};
+
+struct mesh_camera
+{
+    short cx, cy; // Screen position of the centre of the view
+    int focal;    // Projection scale, so a point is drawn at cx + x * focal / z
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void mesh_rotation(struct mesh_matrix *m, int ax, int ay, int az);
+    int mesh_draw(const struct mesh *mesh, const struct mesh_matrix *m, const struct mesh_camera *camera, int flags);
+
+#ifdef __cplusplus
+}
+#endif
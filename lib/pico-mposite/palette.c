@@ -0,0 +1,90 @@
+//
+// Title:	        Pico-mposite Palettes
+// Description:		Palette building and animation
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// The entries are colours as they are scanned out: colour_base plus a brightness on the mono board,
+// or rgb() values on the colour board, which are blended a channel at a time
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "palette.h"
+
+// Set a palette that shows each pixel value as it is, as if there were no palette
+// - palette: The palette to fill in
+//
+void palette_identity(unsigned char *palette)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        palette[i] = i;
+    }
+}
+
+// Fill a palette with one colour, to blend towards for fades and flashes
+// - palette: The palette to fill in
+// - colour: The colour
+//
+void palette_fill(unsigned char *palette, unsigned char colour)
+{
+    memset(palette, colour_base + colour, 256);
+}
+
+// Blend between two palettes
+// - dst: The blended palette; may be a or b
+// - a: The palette at t = 0
+// - b: The palette at t = 256
+// - t: How far between them, 0 to 256
+//
+void palette_blend(unsigned char *dst, const unsigned char *a, const unsigned char *b, int t)
+{
+    for (int i = 0; i < 256; i++)
+    {
+#if opt_colour == 0
+        dst[i] = a[i] + ((b[i] - a[i]) * t >> 8);
+#else
+        int ca = a[i];
+        int cb = b[i];
+        int r = (ca & 7) + (((cb & 7) - (ca & 7)) * t >> 8);
+        int g = (ca >> 3 & 7) + (((cb >> 3 & 7) - (ca >> 3 & 7)) * t >> 8);
+        int bl = (ca >> 6) + (((cb >> 6) - (ca >> 6)) * t >> 8);
+        dst[i] = bl << 6 | g << 3 | r;
+#endif
+    }
+}
+
+// Rotate a range of entries, for colour cycling
+// - palette: The palette
+// - first: First entry of the range
+// - count: Number of entries in it
+// - step: Entries to move each one up by; negative to move them down
+//
+void palette_rotate(unsigned char *palette, int first, int count, int step)
+{
+    unsigned char save[256];
+    if (first < 0 || count <= 0 || first + count > 256)
+    {
+        return;
+    }
+    step %= count;
+    if (step < 0)
+    {
+        step += count;
+    }
+    memcpy(save, &palette[first], count);
+    for (int i = 0; i < count; i++)
+    {
+        int j = i + step;
+        palette[first + (j >= count ? j - count : j)] = save[i];
+    }
+}
@@ -0,0 +1,25 @@
+//
+// Title:	        Pico-mposite Palettes
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Builds and animates the 256 colour palettes handed to set_palette
+//
+// Modinfo:
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void palette_identity(unsigned char *palette);
+    void palette_blend(unsigned char *dst, const unsigned char *a, const unsigned char *b, int t);
+    void palette_fill(unsigned char *palette, unsigned char colour);
+    void palette_rotate(unsigned char *palette, int first, int count, int step);
+
+#ifdef __cplusplus
+}
+#endif
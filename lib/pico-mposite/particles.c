@@ -0,0 +1,180 @@
+//
+// Title:	        Pico-mposite Particles
+// Description:		Fixed point particle pool
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Each particle property is kept in its own array, so the update loop streams through positions
+// and velocities with no floating point. Live particles are packed at the front of the arrays and
+// a dead one is replaced by the last, so nothing is allocated and no time is spent on empty slots.
+// The update works out each particle's row and counts them per row, and the plot walks the
+// particles in row order from that count, so the framebuffer is written top to bottom
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "particles.h"
+
+int32_t particle_x[PARTICLE_MAX]; // Position, 16.16
+int32_t particle_y[PARTICLE_MAX];
+short particle_vx[PARTICLE_MAX]; // Velocity in pixels per frame, 8.8
+short particle_vy[PARTICLE_MAX];
+short particle_life[PARTICLE_MAX]; // Frames left
+unsigned char particle_colour[PARTICLE_MAX];
+
+int particle_count;
+short particle_gravity;
+
+unsigned short particle_order[PARTICLE_MAX]; // Particles in row order, built by particle_plot
+unsigned short particle_row[PARTICLE_ROWS + 1]; // Start of each row in particle_order
+int particle_rows;                              // Rows counted by the last update
+int particle_counted;                           // Particles counted by the last update; any added since wait a frame
+
+uint32_t particle_seed = 2463534242u;
+
+// Fast random number for the emitters (xorshift32)
+//
+static inline uint32_t particle_random(void)
+{
+    particle_seed ^= particle_seed << 13;
+    particle_seed ^= particle_seed >> 17;
+    particle_seed ^= particle_seed << 5;
+    return particle_seed;
+}
+
+// Remove all particles
+//
+void particle_clear(void)
+{
+    particle_count = 0;
+    particle_rows = 0;
+    particle_counted = 0;
+}
+
+// Add a particle
+// - x, y: Position, 16.16
+// - vx, vy: Velocity in pixels per frame, 8.8
+// - life: Frames to live for
+// - colour: Colour
+// Returns
+// - 0 if added, -1 if the pool is full
+//
+int particle_add(int32_t x, int32_t y, short vx, short vy, short life, unsigned char colour)
+{
+    if (particle_count >= PARTICLE_MAX)
+    {
+        return -1;
+    }
+    int i = particle_count++;
+    particle_x[i] = x;
+    particle_y[i] = y;
+    particle_vx[i] = vx;
+    particle_vy[i] = vy;
+    particle_life[i] = life;
+    particle_colour[i] = colour;
+    return 0;
+}
+
+// Launch particles from an emitter
+// - e: The emitter
+// Returns
+// - Number of particles added; fewer than the rate if the pool filled up
+//
+int particle_emit(const struct particle_emitter *e)
+{
+    int n = 0;
+    for (; n < e->rate && particle_count < PARTICLE_MAX; n++)
+    {
+        int angle = e->angle;
+        if (e->spread > 0)
+        {
+            angle += (int)(particle_random() % (e->spread * 2 + 1)) - e->spread;
+        }
+        angle %= 360;
+        angle = angle < 0 ? angle + 360 : angle;
+        int speed = (particle_random() >> 16) * e->speed >> 16; // 0 to speed
+        particle_add(e->x, e->y, (short)(cosTable[angle] * speed >> 10), (short)(sinTable[angle] * speed >> 10), e->life, e->colour);
+    }
+    return n;
+}
+
+// Move the particles on a frame, removing the dead ones and those that have gone off the sides or
+// the bottom. Those above the top are kept, as gravity may bring them back down
+//
+void particle_update(void)
+{
+    int rows = screenHeight < PARTICLE_ROWS ? screenHeight : PARTICLE_ROWS;
+    int width = screenWidth;
+    short g = particle_gravity;
+
+    memset(particle_row, 0, sizeof(particle_row[0]) * (rows + 1));
+    for (int i = 0; i < particle_count;)
+    {
+        particle_vy[i] += g;
+        int32_t x = particle_x[i] + particle_vx[i] * 256;
+        int32_t y = particle_y[i] + particle_vy[i] * 256;
+        int px = x >> 16, py = y >> 16;
+        if (--particle_life[i] <= 0 || (unsigned)px >= (unsigned)width || py >= rows)
+        {
+            int last = --particle_count; // Dead, so move the last particle into its slot
+            particle_x[i] = particle_x[last];
+            particle_y[i] = particle_y[last];
+            particle_vx[i] = particle_vx[last];
+            particle_vy[i] = particle_vy[last];
+            particle_life[i] = particle_life[last];
+            particle_colour[i] = particle_colour[last];
+            continue;
+        }
+        particle_x[i] = x;
+        particle_y[i] = y;
+        if (py >= 0)
+        {
+            particle_row[py + 1]++;
+        }
+        i++;
+    }
+    particle_rows = rows;
+    particle_counted = particle_count;
+}
+
+// Plot the particles into screen_bitmap_next, a row at a time; call after particle_update
+//
+void particle_plot(void)
+{
+    int rows = particle_rows;
+    int width = screenWidth;
+
+    for (int y = 0; y < rows; y++)
+    {
+        particle_row[y + 1] += particle_row[y]; // Turn the counts into the start of each row
+    }
+    for (int i = 0; i < particle_counted; i++)
+    {
+        int py = particle_y[i] >> 16;
+        if (py >= 0) // Above the top, so not counted
+        {
+            particle_order[particle_row[py]++] = i;
+        }
+    }
+    // particle_row[y] is now the end of row y, which is where row y + 1 starts
+    int i = 0;
+    for (int y = 0; y < rows; y++)
+    {
+        unsigned char *row = &screen_bitmap_next[y * width];
+        for (int end = particle_row[y]; i < end; i++)
+        {
+            int p = particle_order[i];
+            row[particle_x[p] >> 16] = colour_base + particle_colour[p];
+        }
+    }
+    particle_rows = 0; // The counts are used up until the next update
+    particle_counted = 0;
+}
@@ -0,0 +1,45 @@
+//
+// Title:	        Pico-mposite Particles
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// A fixed pool of fixed point particles, updated and plotted in batches
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+
+#define PARTICLE_MAX 2048 // Size of the pool; 15 bytes each
+#define PARTICLE_ROWS 576 // Tallest screen, interlaced
+
+struct particle_emitter
+{
+    int32_t x, y;         // Position, 16.16
+    short rate;           // Particles per call to particle_emit
+    short speed;          // Fastest launch speed in pixels per frame, 8.8
+    short angle;          // Direction in degrees, 0 is to the right and 90 is down
+    short spread;         // Launch directions are within this many degrees either side of angle
+    short life;           // Frames each particle lives for
+    unsigned char colour; // Particle colour
+};
+
+extern int particle_count;  // Live particles
+extern short particle_gravity; // Added to each vertical velocity every frame, 8.8
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void particle_clear(void);
+    int particle_add(int32_t x, int32_t y, short vx, short vy, short life, unsigned char colour);
+    int particle_emit(const struct particle_emitter *e);
+    void particle_update(void);
+    void particle_plot(void);
+
+#ifdef __cplusplus
+}
+#endif
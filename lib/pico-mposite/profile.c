@@ -0,0 +1,203 @@
+//
+// Title:	        Pico-mposite Profiler
+// Description:		Per-primitive timing and pixel counts
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// The counts for the frame being drawn are kept in cycles, as the primitives add to them, and
+// converted to microseconds once by profile_frame_end, which also works out the frame summary.
+// The report and the overlay only look at the last completed frame, so they are steady while the
+// next one is counted
+//
+// Modinfo:
+#include <Arduino.h>
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "profile.h"
+
+#if opt_profile
+
+#define PROFILE_OVERLAY_ROWS 8  // Primitives shown by profile_overlay
+#define PROFILE_LABEL 11        // Characters of each name shown
+
+#define PROFILE_NAME(name) #name,
+const char *const profile_names[PROFILE_IDS] = {PROFILE_PRIMITIVES(PROFILE_NAME)};
+#undef PROFILE_NAME
+
+struct profile_count profile_count[PROFILE_IDS]; // The frame being counted
+struct profile_count profile_last[PROFILE_IDS];  // The last completed frame
+struct profile_frame profile_frames[PROFILE_FRAMES]; // Ring of frame summaries
+uint32_t profile_frame_count;   // Frames completed; the latest is at (profile_frame_count - 1) % PROFILE_FRAMES
+uint8_t profile_depth;          // Primitives being run on core 0, nested
+uint8_t profile_current;        // The outermost of them
+uint32_t profile_frame_start;   // time_us_32 when the frame being counted started
+volatile uint32_t profile_isr_cycles; // Running total of cycles in the video ISRs
+uint32_t profile_frame_isr;     // profile_isr_cycles when the frame being counted started
+
+// Start the SysTick counter free running at the system clock
+//
+void initialise_profile(void)
+{
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0xffffff;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 5; // Enable, counting the processor clock, no interrupt
+    profile_frame_start = time_us_32();
+}
+
+// Close the frame being counted; called by swap_video_buffer
+//
+void profile_frame_end(void)
+{
+    uint32_t now = time_us_32();
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    struct profile_frame *f = &profile_frames[profile_frame_count % PROFILE_FRAMES];
+
+    uint32_t isr = profile_isr_cycles;
+    f->period = now - profile_frame_start;
+    f->isr = (isr - profile_frame_isr) / mhz;
+    profile_frame_isr = isr;
+    f->time = 0;
+    f->pixels = 0;
+    f->calls = 0;
+    f->top = 0;
+    for (int i = 0; i < PROFILE_IDS; i++)
+    {
+        struct profile_count *c = &profile_last[i];
+        *c = profile_count[i];
+        c->time /= mhz;
+        f->time += c->time;
+        f->pixels += c->pixels;
+        f->calls += c->calls;
+        if (c->time > profile_last[f->top].time)
+        {
+            f->top = i;
+        }
+        profile_count[i] = (struct profile_count){0, 0, 0};
+    }
+    profile_frame_start = now;
+    profile_frame_count++;
+}
+
+// Print the last frame's counts, and a summary of the frames in the ring
+// - print: Called with each line
+//
+void profile_report(profile_print_t print)
+{
+    char line[100];
+    int frames = profile_frame_count < PROFILE_FRAMES ? profile_frame_count : PROFILE_FRAMES;
+    if (frames == 0)
+    {
+        return;
+    }
+    struct profile_frame *f = &profile_frames[(profile_frame_count - 1) % PROFILE_FRAMES];
+    snprintf(line, sizeof(line), "frame %lu: %lu us, primitives %lu us, video ISRs %lu us, %lu pixels, %lu calls\n",
+             (unsigned long)profile_frame_count - 1, (unsigned long)f->period, (unsigned long)f->time,
+             (unsigned long)f->isr, (unsigned long)f->pixels, (unsigned long)f->calls);
+    print(line);
+    for (int i = 0; i < PROFILE_IDS; i++)
+    {
+        struct profile_count *c = &profile_last[i];
+        if (c->calls)
+        {
+            snprintf(line, sizeof(line), "  %-26s %6lu calls %7lu us %8lu pixels\n", profile_names[i],
+                     (unsigned long)c->calls, (unsigned long)c->time, (unsigned long)c->pixels);
+            print(line);
+        }
+    }
+
+    uint32_t total = 0, worst = 0, period = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        f = &profile_frames[i];
+        total += f->time;
+        period += f->period;
+        if (f->time > worst)
+        {
+            worst = f->time;
+        }
+    }
+    snprintf(line, sizeof(line), "last %d frames: %lu us per frame, primitives %lu us average, %lu us worst\n",
+             frames, (unsigned long)(period / frames), (unsigned long)(total / frames), (unsigned long)worst);
+    print(line);
+}
+
+// Draw the last frame's counts as a bar graph: the frame time, the share of it spent in primitives
+// and the pixels written, then the slowest primitives with bars to the scale of the whole frame
+// - x: X position on screen
+// - y: Y position on screen
+// - w: Width in pixels, at least PROFILE_LABEL characters plus room for the bars
+//
+void profile_overlay(int x, int y, int w)
+{
+    PROFILE(profile_overlay);
+    char text[40];
+    uint8_t shown[PROFILE_OVERLAY_ROWS];
+    int rows = 0;
+    unsigned char fg = opt_colour ? rgb(7, 7, 7) : 15;
+    unsigned char bar = opt_colour ? rgb(0, 7, 0) : 10;
+
+    if (profile_frame_count == 0)
+    {
+        return;
+    }
+    struct profile_frame *f = &profile_frames[(profile_frame_count - 1) % PROFILE_FRAMES];
+
+    // Pick out the slowest primitives, slowest first
+    //
+    while (rows < PROFILE_OVERLAY_ROWS)
+    {
+        int best = -1;
+        for (int i = 0; i < PROFILE_IDS; i++)
+        {
+            bool taken = false;
+            for (int j = 0; j < rows; j++)
+            {
+                taken |= shown[j] == i;
+            }
+            if (!taken && profile_last[i].time && (best < 0 || profile_last[i].time > profile_last[best].time))
+            {
+                best = i;
+            }
+        }
+        if (best < 0)
+        {
+            break;
+        }
+        shown[rows++] = best;
+    }
+
+    fillRect(x, y, w, (rows + 1) * 9 + 1, 0);
+    snprintf(text, sizeof(text), "%lu.%lums %lu%% %lupx", (unsigned long)f->period / 1000,
+             (unsigned long)f->period / 100 % 10, (unsigned long)(f->period ? f->time * 100 / f->period : 0),
+             (unsigned long)f->pixels);
+    for (int i = 0; text[i] && (i + 1) * 6 <= w; i++)
+    {
+        drawChar(x + i * 6, y + 1, text[i], fg, 0, 1, 255);
+    }
+
+    int label = PROFILE_LABEL * 6;
+    for (int r = 0; r < rows; r++)
+    {
+        struct profile_count *c = &profile_last[shown[r]];
+        int ry = y + (r + 1) * 9 + 1;
+        const char *name = profile_names[shown[r]];
+        for (int i = 0; name[i] && i < PROFILE_LABEL - 1; i++)
+        {
+            drawChar(x + i * 6, ry, name[i], fg, 0, 1, 255);
+        }
+        int length = f->period ? (int)((uint64_t)c->time * (w - label) / f->period) : 0;
+        fillRect(x + label, ry, length > 0 ? length : 1, 7, bar);
+    }
+}
+
+#endif
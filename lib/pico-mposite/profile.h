@@ -0,0 +1,188 @@
+//
+// Title:	        Pico-mposite Profiler
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Counts the time and pixels each graphics primitive takes, a frame at a time
+//
+// Each public function in graphics.c starts with PROFILE(name). Time is counted in system clock
+// cycles by SysTick and goes to the outermost primitive only, so drawRect is charged for the lines
+// it draws rather than drawHLine; pixels are charged the same way. Calls from core 1 aren't counted.
+// The video ISRs interrupt core 0 every line, so they time themselves with PROFILE_ISR and that time
+// is taken off whatever primitive they interrupted, and reported for the frame on its own; only
+// the interrupt entry and exit, a few dozen cycles each, are still charged to the primitive.
+// swap_video_buffer closes each frame: the counts are converted to microseconds, kept for
+// profile_report and profile_overlay, and summarised into a ring of the last PROFILE_FRAMES frames
+//
+// With opt_profile set to 0 the macros are empty and nothing here is compiled
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#define PROFILE_FRAMES 64 // Frame summaries kept in the ring
+
+// The profiled primitives; X(name) for each
+//
+#define PROFILE_PRIMITIVES(X)                                                                         \
+    X(clearScreen) X(scroll_up) X(print_char) X(print_string) X(drawPixel) X(getPixel) X(drawVLine)   \
+    X(drawHLine) X(drawLine) X(drawLineThickness) X(drawRect) X(drawRectThickness) X(drawRectCenter) \
+    X(drawRectCenterThickness) X(drawRectRotated) X(drawTriangle) X(fillTriangle)                     \
+    X(drawRectTransparency) X(drawCircleHelper) X(drawCircle) X(drawCircleRotated) X(fillCircle)      \
+    X(filledElipsisTransparency) X(filledElipsisRotated) X(drawRoundRect) X(fillRoundRect)            \
+    X(fillRect) X(fillRectCenter) X(fillRectTransparency) X(drawFillRectRotated)                      \
+    X(drawChar) X(drawCharCustomSize) X(setTextCursor) X(setTextColor) X(setTextColor2)               \
+    X(setTextSize) X(setTextWrap) X(tft_write) X(writeString) X(drawImage) X(drawStar) X(drawPussy)   \
+    X(profile_overlay)
+
+#define PROFILE_ID(name) PROFILE_##name,
+enum profile_id
+{
+    PROFILE_PRIMITIVES(PROFILE_ID)
+    PROFILE_IDS
+};
+#undef PROFILE_ID
+
+struct profile_count // Counts for one primitive
+{
+    uint32_t calls;
+    uint32_t time;   // Cycles while a frame is being counted, microseconds once it's done
+    uint32_t pixels;
+};
+
+struct profile_frame // Summary of one frame
+{
+    uint32_t period; // Microseconds since the previous frame
+    uint32_t time;   // Microseconds spent in primitives
+    uint32_t pixels; // Pixels written
+    uint32_t calls;  // Primitive calls
+    uint32_t isr;    // Microseconds spent in the video ISRs
+    uint8_t top;     // The primitive that took longest
+};
+
+// Prints a line of the report
+// - s: Zero terminated text, ending with a newline
+//
+typedef void (*profile_print_t)(const char *s);
+
+#if opt_profile
+
+#include "hardware/structs/systick.h"
+#include "pico/platform.h"
+
+struct profile_scope // A primitive being timed
+{
+    uint8_t id;
+    uint8_t level;  // 0 on core 1, 1 nested inside another primitive, 2 outermost
+    uint32_t start; // SysTick count on entry
+    uint32_t isr;   // profile_isr_cycles on entry
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    extern struct profile_count profile_count[PROFILE_IDS];
+    extern struct profile_count profile_last[PROFILE_IDS];
+    extern struct profile_frame profile_frames[PROFILE_FRAMES];
+    extern uint32_t profile_frame_count;
+    extern uint8_t profile_depth;
+    extern uint8_t profile_current;
+    extern volatile uint32_t profile_isr_cycles;
+
+    extern const char *const profile_names[PROFILE_IDS];
+
+    void initialise_profile(void);
+    void profile_frame_end(void);
+    void profile_report(profile_print_t print);
+    void profile_overlay(int x, int y, int w);
+
+#ifdef __cplusplus
+}
+#endif
+
+// SysTick counts down from 2^24-1 at the system clock, so a primitive may take up to 2^24 cycles
+//
+static inline uint32_t profile_cycles(void)
+{
+    return 0xffffff - systick_hw->cvr;
+}
+
+// Start timing a primitive
+// - id: The primitive
+// Returns
+// - The scope to hand to profile_end
+//
+static inline struct profile_scope profile_begin(uint8_t id)
+{
+    struct profile_scope s = {id, 0, 0};
+    if (get_core_num() == 0)
+    {
+        s.level = profile_depth++ ? 1 : 2;
+        if (s.level == 2)
+        {
+            profile_current = id;
+            s.isr = profile_isr_cycles;
+            s.start = profile_cycles();
+        }
+    }
+    return s;
+}
+
+// Stop timing a primitive; called as the scope from PROFILE goes out of scope
+// - s: The scope returned by profile_begin
+//
+static inline void profile_end(struct profile_scope *s)
+{
+    if (s->level)
+    {
+        profile_depth--;
+        if (s->level == 2)
+        {
+            struct profile_count *c = &profile_count[s->id];
+            uint32_t isr = profile_isr_cycles - s->isr;
+            uint32_t t = (profile_cycles() - s->start) & 0xffffff;
+            c->time += t > isr ? t - isr : 0; // Less the video ISRs that interrupted it
+            c->calls++;
+        }
+    }
+}
+
+// Count pixels written, charged to the outermost primitive
+// - n: Number of pixels
+//
+static inline void profile_pixels(uint32_t n)
+{
+    if (profile_depth && get_core_num() == 0)
+    {
+        profile_count[profile_current].pixels += n;
+    }
+}
+
+// Add the time since an ISR started to profile_isr_cycles; called as the variable from PROFILE_ISR
+// goes out of scope
+// - start: SysTick count on entry
+//
+static inline void profile_isr_end(uint32_t *start)
+{
+    profile_isr_cycles += (profile_cycles() - *start) & 0xffffff;
+}
+
+#define PROFILE(name) struct profile_scope profile_this __attribute__((cleanup(profile_end))) = profile_begin(PROFILE_##name)
+#define PROFILE_PIXELS(n) profile_pixels(n)
+#define PROFILE_ISR() uint32_t profile_isr_start __attribute__((cleanup(profile_isr_end))) = profile_cycles()
+
+#else
+
+#define PROFILE(name)
+#define PROFILE_PIXELS(n)
+#define PROFILE_ISR()
+
+#endif
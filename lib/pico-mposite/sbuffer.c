@@ -0,0 +1,245 @@
+//
+// Title:	        Pico-mposite Span Buffer
+// Description:		S-buffer hidden surface removal
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// A z-buffer for a 320x240 screen won't fit next to two framebuffers, so each row instead keeps a
+// list of non-overlapping spans sorted by x. A span holds its depth at its left end and the depth
+// step per pixel. Depths are inverse depths (1/z), which are linear across the screen for a flat
+// polygon, so comparing the two ends of an overlap tells which span is in front, or where they
+// cross. Hidden parts of a new span are dropped before anything is drawn, and sbuf_flush writes
+// each visible span to screen_bitmap_next once
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "sbuffer.h"
+
+struct sbuf_span
+{
+    short x0, x1;         // Pixels covered, x1 exclusive
+    short next;           // Next span to the right, or -1
+    unsigned char colour; // Fill colour
+    int32_t w;            // Inverse depth at x0, 24.8; larger is nearer
+    int32_t dw;           // Change in inverse depth per pixel, 24.8
+};
+
+struct sbuf_span sbuf_spans[SBUF_MAX_SPANS];
+short sbuf_head[SBUF_MAX_ROWS]; // First span in each row, or -1
+int sbuf_count;                 // Spans used from the pool
+int sbuf_rows;                  // Rows in use
+
+// Take a span from the pool
+// Returns
+// - Index of the span, or -1 if the pool is used up
+//
+static int sbuf_alloc(void)
+{
+    return sbuf_count < SBUF_MAX_SPANS ? sbuf_count++ : -1;
+}
+
+// Start a scene; clears the span lists
+//
+void sbuf_begin(void)
+{
+    sbuf_rows = screenHeight < SBUF_MAX_ROWS ? screenHeight : SBUF_MAX_ROWS;
+    memset(sbuf_head, 0xff, sizeof(sbuf_head));
+    sbuf_count = 0;
+}
+
+// Add a span, keeping only the parts in front of the spans already in the row
+// - y: Row
+// - x0, x1: Pixels covered, x1 exclusive; must be on screen
+// - w: Inverse depth at x0, 24.8; larger is nearer
+// - dw: Change in inverse depth per pixel, 24.8
+// - colour: Fill colour
+// Returns
+// - false if the span pool ran out, in which case some of the span is missing
+//
+bool sbuf_span(int y, int x0, int x1, int32_t w, int32_t dw, unsigned char colour)
+{
+    short *p = &sbuf_head[y];
+    int cur = x0;
+
+    while (cur < x1)
+    {
+        while (*p >= 0 && sbuf_spans[*p].x1 <= cur)
+        {
+            p = &sbuf_spans[*p].next; // Skip the spans to the left
+        }
+        struct sbuf_span *s = *p >= 0 && sbuf_spans[*p].x0 < x1 ? &sbuf_spans[*p] : NULL;
+        int e;           // End of the piece being decided
+        bool win = true; // Whether the new span shows in it
+        if (s == NULL)
+        {
+            e = x1; // Nothing else in the way
+        }
+        else if (s->x0 > cur)
+        {
+            e = s->x0; // Gap before the next span
+            s = NULL;
+        }
+        else
+        {
+            e = s->x1 < x1 ? s->x1 : x1;
+            int32_t d0 = (w + dw * (cur - x0)) - (s->w + s->dw * (cur - s->x0));
+            int32_t d1 = (w + dw * (e - 1 - x0)) - (s->w + s->dw * (e - 1 - s->x0));
+            win = d0 > 0;
+            if ((d0 > 0) != (d1 > 0))
+            { // They cross; split at the first pixel past the crossing
+                int m = cur + 1 + (int)((int64_t)d0 * (e - 1 - cur) / (d0 - d1));
+                e = m <= cur ? cur + 1 : m >= e ? e - 1 : m;
+            }
+        }
+        if (win)
+        {
+            if (s == NULL)
+            {
+                int n = sbuf_alloc();
+                if (n < 0)
+                {
+                    return false;
+                }
+                sbuf_spans[n].next = *p;
+                *p = n;
+                s = &sbuf_spans[n];
+            }
+            else
+            {
+                if (s->x0 < cur)
+                { // Keep the part of the old span to the left
+                    int n = sbuf_alloc();
+                    if (n < 0)
+                    {
+                        return false;
+                    }
+                    sbuf_spans[n] = *s;
+                    sbuf_spans[n].x1 = cur;
+                    sbuf_spans[n].next = *p;
+                    *p = n;
+                    p = &sbuf_spans[n].next;
+                }
+                if (s->x1 > e)
+                { // And to the right
+                    int n = sbuf_alloc();
+                    if (n < 0)
+                    {
+                        return false;
+                    }
+                    sbuf_spans[n] = *s;
+                    sbuf_spans[n].x0 = e;
+                    sbuf_spans[n].w = s->w + s->dw * (e - s->x0);
+                    s->next = n;
+                }
+            }
+            s->x0 = cur; // The new span takes over this piece
+            s->x1 = e;
+            s->w = w + dw * (cur - x0);
+            s->dw = dw;
+            s->colour = colour;
+            p = &s->next;
+        }
+        cur = e;
+    }
+    return true;
+}
+
+// Add a triangle
+// - x0, y0, x1, y1, x2, y2: The corners, in any order
+// - w0, w1, w2: Inverse depth at each corner, up to 2^20; larger is nearer
+// - colour: Fill colour
+// Returns
+// - false if the span pool ran out
+//
+bool sbuf_triangle(short x0, short y0, int32_t w0, short x1, short y1, int32_t w1, short x2, short y2, int32_t w2, unsigned char colour)
+{
+    int32_t t;
+    if (y0 > y1)
+    {
+        swapNumb(&y0, &y1);
+        swapNumb(&x0, &x1);
+        t = w0, w0 = w1, w1 = t;
+    }
+    if (y1 > y2)
+    {
+        swapNumb(&y1, &y2);
+        swapNumb(&x1, &x2);
+        t = w1, w1 = w2, w2 = t;
+    }
+    if (y0 > y1)
+    {
+        swapNumb(&y0, &y1);
+        swapNumb(&x0, &x1);
+        t = w0, w0 = w1, w1 = t;
+    }
+    bool ok = true;
+    int ys = y0 < 0 ? 0 : y0;
+    int ye = y2 > sbuf_rows ? sbuf_rows : y2;
+    for (int y = ys; y < ye; y++)
+    {
+        int a = x0 + (x2 - x0) * (y - y0) / (y2 - y0); // The long edge
+        int32_t wa = w0 + (w2 - w0) * (y - y0) / (y2 - y0);
+        int b, wb;
+        if (y < y1)
+        {
+            b = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
+            wb = w0 + (w1 - w0) * (y - y0) / (y1 - y0);
+        }
+        else
+        {
+            b = x1 + (x2 - x1) * (y - y1) / (y2 - y1);
+            wb = w1 + (w2 - w1) * (y - y1) / (y2 - y1);
+        }
+        if (a > b)
+        {
+            int n = a;
+            a = b;
+            b = n;
+            t = wa, wa = wb, wb = t;
+        }
+        if (a >= b)
+        {
+            continue;
+        }
+        int32_t dw = ((wb - wa) << 8) / (b - a);
+        wa <<= 8;
+        if (a < 0)
+        {
+            wa -= dw * a;
+            a = 0;
+        }
+        if (b > screenWidth)
+        {
+            b = screenWidth;
+        }
+        if (a < b)
+        {
+            ok &= sbuf_span(y, a, b, wa, dw, colour);
+        }
+    }
+    return ok;
+}
+
+// Draw the visible spans into screen_bitmap_next and clear the lists for the next scene
+//
+void sbuf_flush(void)
+{
+    for (int y = 0; y < sbuf_rows; y++)
+    {
+        unsigned char *row = &screen_bitmap_next[y * screenWidth];
+        for (int i = sbuf_head[y]; i >= 0; i = sbuf_spans[i].next)
+        {
+            memset(row + sbuf_spans[i].x0, colour_base + sbuf_spans[i].colour, sbuf_spans[i].x1 - sbuf_spans[i].x0);
+        }
+    }
+    sbuf_begin();
+}
@@ -0,0 +1,32 @@
+//
+// Title:	        Pico-mposite Span Buffer
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Hidden surface removal for filled polygons with a sorted list of spans per row, so each
+// pixel of a scene is drawn once
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SBUF_MAX_SPANS 2048 // Spans in the pool, shared by all rows; 16 bytes each
+#define SBUF_MAX_ROWS 576   // Tallest screen, interlaced
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void sbuf_begin(void);
+    bool sbuf_span(int y, int x0, int x1, int32_t w, int32_t dw, unsigned char colour);
+    bool sbuf_triangle(short x0, short y0, int32_t w0, short x1, short y1, int32_t w1, short x2, short y2, int32_t w2, unsigned char colour);
+    void sbuf_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,240 @@
+//
+// Title:	        Pico-mposite Shaded Triangles
+// Description:		Dithered flat and Gouraud triangle fills
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Colours come in as 8 bits per channel and are scaled so each channel is a palette level with 16
+// fraction bits: 0 to 7 for red and green, 0 to 3 for blue, or 0 to 15 for the monochrome board.
+// The edges are walked in 16.16 fixed point carrying the channels with them, and each span steps
+// the channels across. Adding the 8x8 Bayer threshold to the top 6 fraction bits and dropping the
+// fraction rounds each pixel up or down in the dither pattern. Spans are written a word at a time;
+// a flat fill works out the two words of the pattern for each of the 8 rows up front
+//
+// Modinfo:
+#include <Arduino.h>
+
+#include "hardware/pio.h"
+
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "shade.h"
+
+struct shade_vertex
+{
+    short x, y;
+    int32_t f[3]; // Channel levels, 16 fraction bits
+};
+
+struct shade_edge
+{
+    int32_t x, dx;       // 16.16
+    int32_t f[3], df[3]; // Channel levels, 16 fraction bits
+};
+
+// Convert a colour into channel levels, 16.16, so that 255 is exactly the top level
+//
+static void shade_levels(uint32_t colour, int32_t *f)
+{
+    int r = (colour >> 16) & 255, g = (colour >> 8) & 255, b = colour & 255;
+#if opt_colour == 0
+    f[0] = (((r * 77 + g * 150 + b * 29) >> 8) * 15 * 65536 + 127) / 255;
+    f[1] = 0;
+    f[2] = 0;
+#else
+    f[0] = (r * 7 * 65536 + 127) / 255;
+    f[1] = (g * 7 * 65536 + 127) / 255;
+    f[2] = (b * 3 * 65536 + 127) / 255;
+#endif
+}
+
+// Dither one pixel
+// - f0, f1, f2: Channel levels
+// - t: Bayer threshold, 0 to 63
+//
+static inline unsigned char shade_pixel(int32_t f0, int32_t f1, int32_t f2, int t)
+{
+#if opt_colour == 0
+    return colour_base + (((f0 >> 10) + t) >> 6);
+#else
+    return (((f0 >> 10) + t) >> 6) | ((((f1 >> 10) + t) >> 6) << 3) | ((((f2 >> 10) + t) >> 6) << 6);
+#endif
+}
+
+// Set up an edge at a row
+// - e: Edge to fill
+// - v0, v1: Top and bottom of the edge; v1 must be below v0
+// - y: Row to start at
+//
+static void shade_edge(struct shade_edge *e, const struct shade_vertex *v0, const struct shade_vertex *v1, int y)
+{
+    int dy = v1->y - v0->y;
+    e->dx = (int32_t)((int64_t)(v1->x - v0->x) * 65536 / dy);
+    e->x = (int32_t)((int64_t)v0->x * 65536 + (int64_t)e->dx * (y - v0->y)) + 0x8000; // Rounded to the pixel
+    for (int i = 0; i < 3; i++)
+    {
+        e->df[i] = (v1->f[i] - v0->f[i]) / dy;
+        e->f[i] = v0->f[i] + e->df[i] * (y - v0->y);
+    }
+}
+
+// Fill a span of a Gouraud shaded row
+//
+static void shade_span(unsigned char *row, int y, int a, int b, int32_t *f, int32_t *df)
+{
+    const int *bayer = bayerMatrix[y & 7];
+    int32_t f0 = f[0], f1 = f[1], f2 = f[2];
+    int x = a;
+
+    for (; x < b && (x & 3); x++, f0 += df[0], f1 += df[1], f2 += df[2])
+    {
+        row[x] = shade_pixel(f0, f1, f2, bayer[x & 7]);
+    }
+    uint32_t *p = (uint32_t *)(row + x); // Rows are word aligned
+    for (; x + 4 <= b; x += 4)
+    {
+        uint32_t w = shade_pixel(f0, f1, f2, bayer[x & 7]);
+        f0 += df[0], f1 += df[1], f2 += df[2];
+        w |= shade_pixel(f0, f1, f2, bayer[(x + 1) & 7]) << 8;
+        f0 += df[0], f1 += df[1], f2 += df[2];
+        w |= shade_pixel(f0, f1, f2, bayer[(x + 2) & 7]) << 16;
+        f0 += df[0], f1 += df[1], f2 += df[2];
+        w |= (uint32_t)shade_pixel(f0, f1, f2, bayer[(x + 3) & 7]) << 24;
+        f0 += df[0], f1 += df[1], f2 += df[2];
+        *p++ = w;
+    }
+    for (; x < b; x++, f0 += df[0], f1 += df[1], f2 += df[2])
+    {
+        row[x] = shade_pixel(f0, f1, f2, bayer[x & 7]);
+    }
+}
+
+// Fill a span of a flat row from its dither pattern
+//
+static void shade_span_flat(unsigned char *row, int a, int b, const uint32_t *pattern)
+{
+    int x = a;
+    for (; x < b && (x & 3); x++)
+    {
+        row[x] = pattern[(x >> 2) & 1] >> ((x & 3) * 8);
+    }
+    uint32_t *p = (uint32_t *)(row + x);
+    for (; x + 4 <= b; x += 4)
+    {
+        *p++ = pattern[(x >> 2) & 1];
+    }
+    for (; x < b; x++)
+    {
+        row[x] = pattern[(x >> 2) & 1] >> ((x & 3) * 8);
+    }
+}
+
+// Walk the edges of a triangle
+// - v: The corners
+// - pattern: Dither pattern for a flat fill, or NULL to shade from the corners
+//
+static void shade_triangle(struct shade_vertex *v, const uint32_t (*pattern)[2])
+{
+    struct shade_vertex *v0 = &v[0], *v1 = &v[1], *v2 = &v[2], *t;
+    if (v0->y > v1->y)
+        t = v0, v0 = v1, v1 = t;
+    if (v1->y > v2->y)
+        t = v1, v1 = v2, v2 = t;
+    if (v0->y > v1->y)
+        t = v0, v0 = v1, v1 = t;
+
+    int ys = v0->y < 0 ? 0 : v0->y;
+    int ye = v2->y > screenHeight ? screenHeight : v2->y;
+    if (ys >= ye)
+    {
+        return;
+    }
+    struct shade_edge l, s; // The long edge and the short edge
+    shade_edge(&l, v0, v2, ys);
+    if (ys < v1->y)
+    {
+        shade_edge(&s, v0, v1, ys);
+    }
+    else
+    {
+        shade_edge(&s, v1, v2, ys); // The upper half is off the top of the screen
+    }
+    for (int y = ys; y < ye; y++)
+    {
+        if (y == v1->y && y != ys)
+        {
+            shade_edge(&s, v1, v2, y); // On to the lower half
+        }
+        struct shade_edge *e0 = l.x < s.x ? &l : &s;
+        struct shade_edge *e1 = l.x < s.x ? &s : &l;
+        int a = e0->x >> 16;
+        int b = e1->x >> 16;
+        if (a < b && b > 0 && a < screenWidth)
+        {
+            unsigned char *row = &screen_bitmap_next[y * screenWidth];
+            int32_t f[3], df[3];
+            for (int i = 0; i < 3; i++)
+            {
+                df[i] = (e1->f[i] - e0->f[i]) / (b - a);
+                f[i] = a < 0 ? e0->f[i] - df[i] * a : e0->f[i];
+            }
+            a = a < 0 ? 0 : a;
+            b = b > screenWidth ? screenWidth : b;
+            if (pattern)
+            {
+                shade_span_flat(row, a, b, pattern[y & 7]);
+            }
+            else
+            {
+                shade_span(row, y, a, b, f, df);
+            }
+        }
+        l.x += l.dx;
+        s.x += s.dx;
+        for (int i = 0; i < 3; i++)
+        {
+            l.f[i] += l.df[i];
+            s.f[i] += s.df[i];
+        }
+    }
+}
+
+// Fill a triangle with a dithered colour
+// Rows from the top corner down to, but not including, the bottom corner are filled, as fillTriangle
+// - x0, y0, x1, y1, x2, y2: The corners, in any order, within +/-16383
+// - colour: Fill colour, rgb888
+//
+void fillTriangleDithered(short x0, short y0, short x1, short y1, short x2, short y2, uint32_t colour)
+{
+    struct shade_vertex v[3] = {{x0, y0}, {x1, y1}, {x2, y2}};
+    uint32_t pattern[8][2];
+    int32_t f[3];
+
+    shade_levels(colour, f);
+    for (int y = 0; y < 8; y++)
+    {
+        pattern[y][0] = pattern[y][1] = 0;
+        for (int x = 0; x < 8; x++)
+        {
+            pattern[y][x >> 2] |= (uint32_t)shade_pixel(f[0], f[1], f[2], bayerMatrix[y][x]) << ((x & 3) * 8);
+        }
+    }
+    shade_triangle(v, pattern);
+}
+
+// Fill a triangle, blending smoothly between the colours at its corners
+// - x0, y0, x1, y1, x2, y2: The corners, in any order, within +/-16383
+// - c0, c1, c2: The colour at each corner, rgb888
+//
+void fillTriangleGouraud(short x0, short y0, uint32_t c0, short x1, short y1, uint32_t c1, short x2, short y2, uint32_t c2)
+{
+    struct shade_vertex v[3] = {{x0, y0}, {x1, y1}, {x2, y2}};
+
+    shade_levels(c0, v[0].f);
+    shade_levels(c1, v[1].f);
+    shade_levels(c2, v[2].f);
+    shade_triangle(v, NULL);
+}
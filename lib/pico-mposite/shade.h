@@ -0,0 +1,27 @@
+//
+// Title:	        Pico-mposite Shaded Triangles
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Flat and Gouraud shaded triangles, ordered dithered down to the palette
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+
+#define rgb888(r, g, b) (((uint32_t)(r) << 16) | ((g) << 8) | (b)) // Full colour for the shaded fills; the monochrome board uses its brightness
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void fillTriangleDithered(short x0, short y0, short x1, short y1, short x2, short y2, uint32_t colour);
+    void fillTriangleGouraud(short x0, short y0, uint32_t c0, short x1, short y1, uint32_t c1, short x2, short y2, uint32_t c2);
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,6 +7,10 @@
 //
 // Modinfo:
 // 03/03/2022:      Added colour
+// 18/10/2026:      Scrolls with the hardware scroll
+//                  Now runs in text mode
+//                  UART received by DMA into a ring buffer, drained and rendered once per frame
+//                  Added a VT100/ANSI escape sequence parser
 #include <Arduino.h>
 #include "pico/stdlib.h"
 
@@ -17,72 +21,478 @@
 
 #include "cvideo.h"
 #include "graphics.h"
+#include "textmode.h"
 
 #include "terminal.h"
 
 int terminal_x;
 int terminal_y;
 
-void initialise_terminal(void) {
-    uart_init(uart0, 115200);
+unsigned char uart_ring[UART_RING_SIZE] __attribute__((aligned(UART_RING_SIZE))); // DMA wraps on this alignment
+uint uart_dma_channel;  // DMA channel copying the UART receive FIFO into the ring
+uint uart_ring_read;    // Next byte of the ring to be processed
+
+uint32_t terminal_dirty[TEXT_MAX_ROWS][(TEXT_MAX_COLS + 31) / 32];  // Cells to repaint, by cell buffer row
+int terminal_scrolls;   // Rows scrolled since the last repaint
+int cursor_x = -1;      // Where the cursor was last painted
+int cursor_y = -1;
+
+enum { STATE_NORMAL, STATE_ESC, STATE_CSI };   // Escape sequence parser states
+
+int terminal_state;     // Parser state
+int terminal_param[TERMINAL_PARAMS];            // CSI parameters, -1 if omitted
+int terminal_params;    // Number of CSI parameters
+bool terminal_private;  // CSI sequence started with '?'
+unsigned char terminal_attr;                    // Current attribute, set by SGR
+bool terminal_wrap;     // Last column written; wrap on the next printable character
+bool terminal_cursor;   // Cursor visible
+int terminal_top;       // Scroll region, inclusive
+int terminal_bottom;
+int saved_x, saved_y;   // Saved by ESC 7 and CSI s
+unsigned char saved_attr;
+
+// Start the UART receive DMA
+//
+static void start_uart_dma(void) {
+    dma_channel_config c = dma_channel_get_default_config(uart_dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, UART_RING_BITS);     // Wrap the write address round the ring
+    channel_config_set_dreq(&c, uart_get_dreq(uart0, false));
+    dma_channel_configure(uart_dma_channel, &c,
+        &uart_ring[uart_ring_read],                         // Carry on from where processing has got to
+        &uart_get_hw(uart0)->dr,
+        0xFFFFFFFF,                                         // As many bytes as possible
+        true
+    );
+}
+
+// Initialise the UART
+// - baud: Baud rate
+//
+void initialise_terminal(uint baud) {
+    uart_init(uart0, baud);
     gpio_set_function(12, GPIO_FUNC_UART);  // TX
     gpio_set_function(13, GPIO_FUNC_UART);  // RX
+    uart_dma_channel = dma_claim_unused_channel(true);
+    uart_ring_read = 0;
+    start_uart_dma();
+}
+
+// Mark a cell as needing a repaint
+// - x, y: Cell position on screen
+//
+static inline void dirty(int x, int y) {
+    int row = (text_cell(0, y) - text_cells) / text_cols;  // Track by cell buffer row, which doesn't move on scroll
+    terminal_dirty[row][x >> 5] |= 1u << (x & 31);
+}
+
+// Mark a run of cells in a row as needing a repaint
+// - x1, x2: First and last column, inclusive
+// - y: Row on screen
+//
+static void dirty_span(int x1, int x2, int y) {
+    for(int x = x1; x <= x2; x++) {
+        dirty(x, y);
+    }
+}
+
+// Blank a run of cells in a row with the current background
+// - x1, x2: First and last column, inclusive
+// - y: Row on screen
+//
+static void erase(int x1, int x2, int y) {
+    unsigned char attr = terminal_attr & 0xF0;
+    struct text_cell *cell = text_cell(0, y);
+    for(int x = x1; x <= x2; x++) {
+        cell[x].ch = ' ';
+        cell[x].attr = attr;
+    }
+    dirty_span(x1, x2, y);
+}
+
+// Scroll the scroll region
+// - lines: Number of rows to scroll up by; negative to scroll down
+// - top: First row of the area to scroll, which runs to the bottom of the scroll region
+//
+static void scroll(int lines, int top) {
+    if(lines > 0 && top == 0 && terminal_bottom == text_rows - 1) {
+        for(int i = 0; i < lines && i < text_rows; i++) {  // The whole screen; rotate the rows
+            text_scroll_up(terminal_attr & 0xF0);
+            dirty_span(0, text_cols - 1, text_rows - 1);  // The background may not be the one scroll_up clears with
+            terminal_scrolls++;
+        }
+    }
+    else {
+        text_scroll_region(top, terminal_bottom, lines, terminal_attr & 0xF0);
+        for(int y = top; y <= terminal_bottom; y++) {
+            dirty_span(0, text_cols - 1, y);
+        }
+    }
+}
+
+// Move down a line, scrolling if at the bottom of the scroll region
+//
+static void lf(void) {
+    terminal_wrap = false;
+    if(terminal_y == terminal_bottom) {
+        scroll(1, terminal_top);
+    }
+    else if(terminal_y < text_rows - 1) {
+        terminal_y++;
+    }
+}
+
+// Move up a line, scrolling if at the top of the scroll region
+//
+static void ri(void) {
+    terminal_wrap = false;
+    if(terminal_y == terminal_top) {
+        scroll(-1, terminal_top);
+    }
+    else if(terminal_y > 0) {
+        terminal_y--;
+    }
+}
+
+// Move the cursor, clipped to the screen
+// - x, y: New cursor position
+//
+static void move_to(int x, int y) {
+    terminal_x = x < 0 ? 0 : x >= text_cols ? text_cols - 1 : x;
+    terminal_y = y < 0 ? 0 : y >= text_rows ? text_rows - 1 : y;
+    terminal_wrap = false;
 }
 
 // Handle carriage returns
 //
 void cr(void) {
     terminal_x = 0;
-    terminal_y += 8;
-    if(terminal_y >= height) {
-        terminal_y -= 8;
-        scroll_up(15, 8);
-    }
+    terminal_wrap = false;
 }
 
-// Advance one character position
+// Output a printable character
+// Wraps lazily, so writing the last column doesn't scroll until another character follows
 //
-void fs(void) {
-    terminal_x += 8;
-    if(terminal_x >= width) {
+void fs(char c) {
+    if(terminal_wrap) {
         cr();
+        lf();
+    }
+    text_putc(terminal_x, terminal_y, c, terminal_attr);
+    dirty(terminal_x, terminal_y);
+    if(terminal_x < text_cols - 1) {
+        terminal_x++;
+    }
+    else {
+        terminal_wrap = true;
     }
 }
 
 // Backspace
 //
 void bs(void) {
-    terminal_x -= 8;
-    if(terminal_x < 0) {
-        terminal_x = 0;
+    terminal_wrap = false;
+    if(terminal_x > 0) {
+        terminal_x--;
     }
 }
 
-// The terminal loop
+// Reset the terminal state
 //
-void terminal(void) {
-    terminal_x = 0;
-    terminal_y = 0;
-    while(true) {
-        print_char(terminal_x, terminal_y, '_', col_terminal_cursor, col_terminal_bg);
-        char c = uart_getc(uart0);          // Get the character from the UART (blocking)
-        if(c >= 32) {                       // Output printable characters
-            print_char(terminal_x, terminal_y, c, col_terminal_fg, col_terminal_bg);
-            fs();
+static void terminal_reset(void) {
+    terminal_state = STATE_NORMAL;
+    terminal_attr = attr_terminal;
+    terminal_wrap = false;
+    terminal_cursor = true;
+    terminal_top = 0;
+    terminal_bottom = text_rows - 1;
+    saved_x = saved_y = 0;
+    saved_attr = attr_terminal;
+}
+
+// Get a CSI parameter
+// - i: Parameter index
+// - def: Value if omitted or zero
+//
+static inline int param(int i, int def) {
+    return i < terminal_params && terminal_param[i] > 0 ? terminal_param[i] : def;
+}
+
+// Select graphic rendition; the colours map straight onto the ANSI ordered text_palette
+//
+static void sgr(void) {
+    if(terminal_params == 0) {
+        terminal_params = 1;
+        terminal_param[0] = 0;
+    }
+    for(int i = 0; i < terminal_params; i++) {
+        int p = terminal_param[i] < 0 ? 0 : terminal_param[i];
+        unsigned char fg = terminal_attr & 15;
+        unsigned char bg = terminal_attr >> 4;
+        if(p == 0) {
+            fg = attr_terminal & 15;
+            bg = attr_terminal >> 4;
+        }
+        else if(p == 1) fg |= 8;                            // Bold is shown as bright
+        else if(p == 22) fg &= 7;
+        else if(p == 7 || p == 27) {                        // Inverse on and off both swap; near enough
+            unsigned char t = fg; fg = bg; bg = t;
+        }
+        else if(p >= 30 && p <= 37) fg = (fg & 8) | (p - 30);
+        else if(p == 39) fg = attr_terminal & 15;
+        else if(p >= 40 && p <= 47) bg = p - 40;
+        else if(p == 49) bg = attr_terminal >> 4;
+        else if(p >= 90 && p <= 97) fg = p - 90 + 8;
+        else if(p >= 100 && p <= 107) bg = p - 100 + 8;
+        terminal_attr = text_attr(fg, bg);
+    }
+}
+
+// Execute a CSI sequence
+// - c: Final character
+//
+static void csi(char c) {
+    int n = param(0, 1);
+    switch(c) {
+        case 'A': move_to(terminal_x, terminal_y - n); break;   // CUU
+        case 'B': move_to(terminal_x, terminal_y + n); break;   // CUD
+        case 'C': move_to(terminal_x + n, terminal_y); break;   // CUF
+        case 'D': move_to(terminal_x - n, terminal_y); break;   // CUB
+        case 'E': move_to(0, terminal_y + n); break;            // CNL
+        case 'F': move_to(0, terminal_y - n); break;            // CPL
+        case 'G': move_to(n - 1, terminal_y); break;            // CHA
+        case 'd': move_to(terminal_x, n - 1); break;            // VPA
+        case 'H':                                               // CUP
+        case 'f': move_to(param(1, 1) - 1, n - 1); break;
+        case 'J':                                               // ED
+            switch(param(0, 0)) {
+                case 0:
+                    erase(terminal_x, text_cols - 1, terminal_y);
+                    for(int y = terminal_y + 1; y < text_rows; y++) erase(0, text_cols - 1, y);
+                    break;
+                case 1:
+                    for(int y = 0; y < terminal_y; y++) erase(0, text_cols - 1, y);
+                    erase(0, terminal_x, terminal_y);
+                    break;
+                default:
+                    for(int y = 0; y < text_rows; y++) erase(0, text_cols - 1, y);
+                    break;
+            }
+            break;
+        case 'K':                                               // EL
+            switch(param(0, 0)) {
+                case 0: erase(terminal_x, text_cols - 1, terminal_y); break;
+                case 1: erase(0, terminal_x, terminal_y); break;
+                default: erase(0, text_cols - 1, terminal_y); break;
+            }
+            break;
+        case 'L':                                               // IL
+        case 'M':                                               // DL
+            if(terminal_y >= terminal_top && terminal_y <= terminal_bottom) {
+                scroll(c == 'M' ? n : -n, terminal_y);
+                terminal_x = 0;
+            }
+            break;
+        case 'S': scroll(n, terminal_top); break;               // SU
+        case 'T': scroll(-n, terminal_top); break;              // SD
+        case 'm': sgr(); break;                                 // SGR
+        case 'r': {                                             // DECSTBM
+            int top = param(0, 1) - 1;
+            int bottom = param(1, text_rows) - 1;
+            if(top < bottom && bottom < text_rows) {
+                terminal_top = top;
+                terminal_bottom = bottom;
+                move_to(0, 0);
+            }
+            break;
         }
-        else {                              // Else deal with the important control characters
-            print_char(terminal_x, terminal_y, ' ', col_terminal_fg, col_terminal_bg);  
+        case 's': saved_x = terminal_x; saved_y = terminal_y; break;
+        case 'u': move_to(saved_x, saved_y); break;
+        case 'h':                                               // DECTCEM, show cursor
+        case 'l':                                               // and hide cursor
+            if(terminal_private && param(0, 0) == 25) {
+                terminal_cursor = c == 'h';
+            }
+            break;
+    }
+}
+
+// Process a character
+// Returns
+// - false if the terminal should quit
+//
+static bool terminal_char(char c) {
+    switch(terminal_state) {
+        case STATE_ESC:
+            terminal_state = STATE_NORMAL;
             switch(c) {
-                case 0x08:  // Backspace
-                    bs();
+                case '[':
+                    terminal_state = STATE_CSI;
+                    terminal_params = 0;
+                    terminal_param[0] = -1;
+                    terminal_private = false;
+                    break;
+                case 'D': lf(); break;                          // IND
+                case 'E': cr(); lf(); break;                    // NEL
+                case 'M': ri(); break;                          // RI
+                case '7':                                       // DECSC
+                    saved_x = terminal_x; saved_y = terminal_y; saved_attr = terminal_attr;
+                    break;
+                case '8':                                       // DECRC
+                    move_to(saved_x, saved_y); terminal_attr = saved_attr;
                     break;
-                case 0x0D:  // CR
-                    cr();
+                case 'c':                                       // RIS
+                    terminal_reset();
+                    for(int y = 0; y < text_rows; y++) erase(0, text_cols - 1, y);
+                    move_to(0, 0);
                     break;
-                case 0x03:  // Ctrl+C       // Quit the terminal loop on these codes
-                case 0x1B:  // ESC
-                    return;
+            }
+            return true;
+        case STATE_CSI:
+            if(c >= '0' && c <= '9') {
+                int *p = &terminal_param[terminal_params];
+                *p = (*p < 0 ? 0 : *p * 10) + c - '0';
+                if(*p > 9999) *p = 9999;
+            }
+            else if(c == ';') {
+                if(terminal_params < TERMINAL_PARAMS - 1) {
+                    terminal_param[++terminal_params] = -1;
+                }
+            }
+            else if(c == '?') {
+                terminal_private = true;
+            }
+            else if(c >= 0x40 && c <= 0x7E) {                   // Final character
+                terminal_params++;
+                terminal_state = STATE_NORMAL;
+                csi(c);
+            }
+            else if(c == 0x18 || c == 0x1A) {                   // CAN and SUB abort the sequence
+                terminal_state = STATE_NORMAL;
+            }
+            return true;
+    }
+    if(c >= 32 && c < 127) {                // Output printable characters
+        fs(c);
+        return true;
+    }
+    switch(c) {                             // Else deal with the control characters
+        case 0x03:  // Ctrl+C               // Quit the terminal loop
+            return false;
+        case 0x08:  // Backspace
+            bs();
+            break;
+        case 0x09:  // Tab
+            move_to((terminal_x + 8) & ~7, terminal_y);
+            break;
+        case 0x0A:  // LF, VT and FF
+        case 0x0B:
+        case 0x0C:
+            lf();
+            break;
+        case 0x0D:  // CR
+            cr();
+            break;
+        case 0x1B:  // ESC
+            terminal_state = STATE_ESC;
+            break;
+    }
+    return true;
+}
+
+// Paint a cell into the bitmap
+//
+static void paint(int x, int y, bool inverse) {
+    struct text_cell *cell = text_cell(x, y);
+    unsigned char fc = text_palette[cell->attr & 15];
+    unsigned char bc = text_palette[cell->attr >> 4];
+    print_char(x * 8, y * 8, cell->ch, inverse ? fc : bc, inverse ? bc : fc);
+}
+
+// Repaint the dirty cells
+// In text mode the cells are already on screen, so this just moves the cursor; in a bitmap
+// mode the scroll is applied with the hardware scroll and only the dirty cells are redrawn
+//
+void terminal_render(void) {
+    if(scanline_renderer == text_render_line) {
+        memset(terminal_dirty, 0, sizeof(terminal_dirty));
+        terminal_scrolls = 0;
+        text_set_cursor(terminal_x, terminal_y, terminal_cursor);
+        return;
+    }
+    if(terminal_scrolls) {
+        int rows = terminal_scrolls < text_rows ? terminal_scrolls : text_rows;
+        scroll_up(text_palette[terminal_attr >> 4], rows * 8);
+        cursor_y -= terminal_scrolls;
+        terminal_scrolls = 0;
+    }
+    if(cursor_y >= 0) {                     // Restore the cell under the old cursor
+        dirty(cursor_x, cursor_y);
+        cursor_y = -1;
+    }
+    for(int y = 0; y < text_rows; y++) {
+        uint32_t *d = terminal_dirty[(text_cell(0, y) - text_cells) / text_cols];
+        for(int w = 0; w < (text_cols + 31) / 32; w++) {
+            while(d[w]) {
+                int x = w * 32 + __builtin_ctz(d[w]);
+                d[w] &= d[w] - 1;
+                paint(x, y, false);
             }
         }
     }
-}
\ No newline at end of file
+    if(terminal_cursor) {
+        paint(terminal_x, terminal_y, true);
+        cursor_x = terminal_x;
+        cursor_y = terminal_y;
+    }
+}
+
+// Process everything received since the last call, then repaint; call once a frame
+// Returns
+// - false if the terminal should quit
+//
+bool terminal_update(void) {
+    uint write = (uint)((uintptr_t)dma_channel_hw_addr(uart_dma_channel)->write_addr - (uintptr_t)uart_ring);
+    bool running = true;
+    while(running && uart_ring_read != write) {
+        running = terminal_char(uart_ring[uart_ring_read]);
+        uart_ring_read = (uart_ring_read + 1) & (UART_RING_SIZE - 1);
+    }
+    if(!dma_channel_is_busy(uart_dma_channel)) {
+        start_uart_dma();                   // Restart if the transfer count has run out
+    }
+    terminal_render();
+    return running;
+}
+
+// Start the terminal on the current screen
+// Call set_text_mode first, or set_mode for a terminal drawn into the bitmap
+//
+void terminal_start(void) {
+    if(scanline_renderer != text_render_line) {
+        text_set_size(screenWidth / 8, screenHeight / 8);
+        memset(screen_bitmap, colour_base + text_palette[attr_terminal >> 4], screenWidth * screenHeight);
+        set_scroll(0, 0);
+    }
+    terminal_x = 0;
+    terminal_y = 0;
+    cursor_x = -1;
+    cursor_y = -1;
+    terminal_scrolls = 0;
+    terminal_reset();
+    text_clear(attr_terminal);
+    memset(terminal_dirty, 0, sizeof(terminal_dirty));
+}
+
+// The terminal loop
+// Only returns on Ctrl+C
+//
+void terminal(void) {
+    terminal_start();
+    while(terminal_update()) {
+        wait_vblank();
+    }
+    text_set_cursor(0, 0, false);
+}
@@ -6,6 +6,9 @@
 //
 // Modinfo:
 // 03/03/2022:      Added colour
+// 18/10/2026:      Added attr_terminal for text mode
+//                  Added terminal_start, terminal_update and terminal_render
+//                  Added TERMINAL_PARAMS for the escape sequence parser
 
 #pragma once
 
@@ -23,5 +26,22 @@
     #define col_terminal_cursor rgb(7,7,7)
 #endif 
 
-void initialise_terminal(void);
-void terminal(void);
\ No newline at end of file
+#define attr_terminal text_attr(11, 0) // Yellow on black, from text_palette
+
+#define UART_RING_BITS 12                   // Size of the UART receive ring as a power of two
+#define UART_RING_SIZE (1 << UART_RING_BITS)
+
+#define TERMINAL_PARAMS 8                   // Maximum number of parameters in a CSI sequence
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void initialise_terminal(uint baud);
+    void terminal_start(void);
+    bool terminal_update(void);
+    void terminal_render(void);
+    void terminal(void);
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
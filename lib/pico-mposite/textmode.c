@@ -0,0 +1,258 @@
+//
+// Title:	        Pico-mposite Text Mode
+// Description:		Character cell screen rendered at scanout
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Each cell is two bytes, so an 80x30 screen takes 4.8K, or 9.6K for 80x60 interlaced. The glyphs come from the Spectrum
+// character set and are expanded into the scanout line buffer four pixels per word, using a
+// nibble mask to select between the foreground and background colours
+//
+// Modinfo:
+#include <Arduino.h>
+#include <string.h>
+
+#include "hardware/pio.h"
+#include "hardware/irq.h"
+
+#include "charset.h" // The character set
+#include "cvideo.h"
+#include "graphics.h"
+
+#include "textmode.h"
+
+int text_cols;
+int text_rows;
+
+#if opt_colour == 0
+unsigned char text_palette[16] = {
+    0, 4, 6, 8, 3, 5, 7, 11,
+    5, 9, 11, 14, 7, 10, 13, 15};
+#else
+unsigned char text_palette[16] = { // In ANSI order
+    rgb(0, 0, 0), rgb(5, 0, 0), rgb(0, 5, 0), rgb(5, 3, 0),
+    rgb(0, 0, 4), rgb(5, 0, 4), rgb(0, 5, 4), rgb(5, 5, 4),
+    rgb(2, 2, 2), rgb(7, 2, 2), rgb(2, 7, 2), rgb(7, 7, 2),
+    rgb(2, 2, 6), rgb(7, 2, 6), rgb(2, 7, 6), rgb(7, 7, 6)};
+#endif
+
+struct text_cell text_cells[TEXT_MAX_COLS * TEXT_MAX_ROWS];
+
+int text_top;           // Cell row shown at the top of the screen; scrolling just moves this
+int cursor_col = -1;    // Cursor position, shown as a flashing inverse cell
+int cursor_row = -1;
+uint text_frame;        // Frame counter for the cursor flash
+
+// Masks to expand a nibble of glyph data into four pixels, leftmost pixel in the low byte
+//
+static const uint32_t nibble_mask[16] = {
+    0x00000000, 0xff000000, 0x00ff0000, 0xffff0000,
+    0x0000ff00, 0xff00ff00, 0x00ffff00, 0xffffff00,
+    0x000000ff, 0xff0000ff, 0x00ff00ff, 0xffff00ff,
+    0x0000ffff, 0xff00ffff, 0x00ffffff, 0xffffffff};
+
+// Set a text mode
+// mode - The graphics mode to base it on, as set_mode; 8x8 cells
+// Returns
+// - 0 if successful, -1 if the mode can't be set
+//
+int set_text_mode(int mode)
+{
+    if (set_scanline_mode(mode, text_render_line) < 0)
+    {
+        return -1;
+    }
+    text_set_size(screenWidth / 8, screenHeight / 8);
+    text_clear(text_attr(7, 0));
+    return 0;
+}
+
+// Set the size of the cell screen, for when it is used without the text mode
+// - cols, rows: Size in cells, up to TEXT_MAX_COLS by TEXT_MAX_ROWS
+//
+void text_set_size(int cols, int rows)
+{
+    text_cols = cols < TEXT_MAX_COLS ? cols : TEXT_MAX_COLS;
+    text_rows = rows < TEXT_MAX_ROWS ? rows : TEXT_MAX_ROWS;
+    text_top = 0;
+}
+
+// Get a cell
+// - col, row: Position on screen
+// Returns
+// - Pointer to the cell; cells in a row are consecutive
+//
+struct text_cell *text_cell(int col, int row)
+{
+    row += text_top;
+    if (row >= text_rows)
+    {
+        row -= text_rows;
+    }
+    return &text_cells[row * text_cols + col];
+}
+
+// Clear the screen
+// - attr: Attribute to fill with
+//
+void text_clear(unsigned char attr)
+{
+    for (int i = 0; i < text_cols * text_rows; i++)
+    {
+        text_cells[i].ch = ' ';
+        text_cells[i].attr = attr;
+    }
+}
+
+// Put a character
+// - col, row: Position on screen
+// - c: Character to print (ASCII 32 to 127)
+// - attr: Cell attribute
+//
+void text_putc(int col, int row, int c, unsigned char attr)
+{
+    if (col >= 0 && col < text_cols && row >= 0 && row < text_rows)
+    {
+        struct text_cell *cell = text_cell(col, row);
+        cell->ch = c;
+        cell->attr = attr;
+    }
+}
+
+// Print a string; clipped at the end of the row
+// - col, row: Position on screen
+// - s: Zero terminated string
+// - attr: Cell attribute
+//
+void text_print(int col, int row, const char *s, unsigned char attr)
+{
+    while (*s)
+    {
+        text_putc(col++, row, *s++, attr);
+    }
+}
+
+// Change the attribute of a run of cells without touching the characters
+// - col, row: Position of the first cell
+// - count: Number of cells; clipped at the end of the row
+// - attr: Cell attribute
+//
+void text_set_attr(int col, int row, int count, unsigned char attr)
+{
+    if (row < 0 || row >= text_rows)
+    {
+        return;
+    }
+    struct text_cell *cell = text_cell(0, row);
+    int end = col + count > text_cols ? text_cols : col + count;
+    for (int i = col < 0 ? 0 : col; i < end; i++)
+    {
+        cell[i].attr = attr;
+    }
+}
+
+// Scroll the screen up a row
+// - attr: Attribute for the blank row scrolled in at the bottom
+//
+void text_scroll_up(unsigned char attr)
+{
+    struct text_cell *cell = text_cell(0, 0); // The top row becomes the bottom row
+    for (int i = 0; i < text_cols; i++)
+    {
+        cell[i].ch = ' ';
+        cell[i].attr = attr;
+    }
+    text_top = text_top + 1 >= text_rows ? 0 : text_top + 1;
+}
+
+// Scroll part of the screen; rows are copied, so prefer text_scroll_up for the whole screen
+// - top, bottom: First and last row of the area to scroll, inclusive
+// - lines: Number of rows to scroll up by; negative to scroll down
+// - attr: Attribute for the blank rows scrolled in
+//
+void text_scroll_region(int top, int bottom, int lines, unsigned char attr)
+{
+    int height = bottom - top + 1;
+    int n = lines < 0 ? -lines : lines;
+    if (n > height)
+    {
+        n = height;
+    }
+    for (int i = 0; i < height; i++)
+    {
+        int row = lines > 0 ? top + i : bottom - i; // Copy away from the direction of scroll
+        struct text_cell *dst = text_cell(0, row);
+        if (i < height - n)
+        {
+            memcpy(dst, text_cell(0, lines > 0 ? row + n : row - n), text_cols * sizeof(struct text_cell));
+        }
+        else
+        {
+            for (int col = 0; col < text_cols; col++)
+            {
+                dst[col].ch = ' ';
+                dst[col].attr = attr;
+            }
+        }
+    }
+}
+
+// Position the cursor
+// - col, row: Position on screen
+// - visible: Set to false to hide it
+//
+void text_set_cursor(int col, int row, bool visible)
+{
+    cursor_col = visible ? col : -1;
+    cursor_row = row;
+}
+
+// Expand one cell row of glyph data into pixels
+//
+static inline uint32_t *expand_cell(uint32_t *dst, unsigned char data, unsigned char fc, unsigned char bc)
+{
+    uint32_t fg = (colour_base + fc) * 0x01010101u;
+    uint32_t bg = (colour_base + bc) * 0x01010101u;
+    uint32_t m = nibble_mask[data >> 4];
+    *dst++ = (fg & m) | (bg & ~m);
+    m = nibble_mask[data & 15];
+    *dst++ = (fg & m) | (bg & ~m);
+    return dst;
+}
+
+// Render a line of text; the scanline renderer for the text modes
+// - dst: Line buffer to fill
+// - line: Active line number
+//
+void text_render_line(unsigned char *dst, int line)
+{
+    uint32_t *p = (uint32_t *)dst;
+    int row = line >> 3;
+    int y = line & 7;
+
+    if (line == 0)
+    {
+        text_frame++;
+    }
+    if (row >= text_rows)
+    {
+        memset(dst, colour_base + text_palette[0], screenWidth);
+        return;
+    }
+    const struct text_cell *cell = text_cell(0, row);
+    for (int col = 0; col < text_cols; col++, cell++)
+    {
+        unsigned char c = cell->ch;
+        unsigned char data = c >= 32 && c < 128 ? charset[(c - 32) * 8 + y] : 0;
+        p = expand_cell(p, data, text_palette[cell->attr & 15], text_palette[cell->attr >> 4]);
+    }
+    if (row == cursor_row && cursor_col >= 0 && cursor_col < text_cols && (text_frame & 16))
+    {
+        cell = text_cell(cursor_col, row); // Redraw the cursor cell inverted
+        unsigned char c = cell->ch;
+        unsigned char data = c >= 32 && c < 128 ? charset[(c - 32) * 8 + y] : 0;
+        expand_cell((uint32_t *)dst + cursor_col * 2, data, text_palette[cell->attr >> 4], text_palette[cell->attr & 15]);
+    }
+}
@@ -0,0 +1,56 @@
+//
+// Title:	        Pico-mposite Text Mode
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// A character cell screen that is expanded into pixels a line at a time during scanout,
+// so a full screen of text needs no bitmap
+//
+// Modinfo:
+// 18/10/2026:      Room for the interlaced modes
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "config.h"
+
+#define TEXT_MAX_COLS 80 // 640 pixel mode
+#define TEXT_MAX_ROWS 72 // 576 lines, interlaced
+
+#define text_attr(fg, bg) (((bg) << 4) | (fg)) // Cell attribute from two text_palette indexes
+
+struct text_cell
+{
+    unsigned char ch;   // ASCII 32 to 127, anything else shows as a space
+    unsigned char attr; // Foreground palette index in the low nibble, background in the high nibble
+};
+
+extern int text_cols;
+extern int text_rows;
+extern unsigned char text_palette[16];
+extern struct text_cell text_cells[TEXT_MAX_COLS * TEXT_MAX_ROWS];
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int set_text_mode(int mode);
+    void text_set_size(int cols, int rows);
+
+    void text_clear(unsigned char attr);
+    void text_putc(int col, int row, int c, unsigned char attr);
+    void text_print(int col, int row, const char *s, unsigned char attr);
+    void text_set_attr(int col, int row, int count, unsigned char attr);
+    void text_scroll_up(unsigned char attr);
+    void text_scroll_region(int top, int bottom, int lines, unsigned char attr);
+    void text_set_cursor(int col, int row, bool visible);
+    struct text_cell *text_cell(int col, int row);
+
+    void text_render_line(unsigned char *dst, int line);
+
+#ifdef __cplusplus
+}
+#endif
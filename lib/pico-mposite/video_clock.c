@@ -0,0 +1,92 @@
+//
+// Title:	        Pico-mposite Video Clock
+// Description:		Clock divider planning for the video state machines
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Modinfo:
+
+#include <math.h>
+
+#include "video_clock.h"
+
+#define XOSC_HZ 12000000 // Crystal the system PLL runs from
+
+// Work out a PIO clock divider
+// - sys_hz: System clock
+// - sm_hz: State machine clock wanted
+// - error_ppm: Set to how far out the resulting clock is, in parts per million
+// Returns
+// - The divider in SMx_CLKDIV format, rounded to the nearest 1/256
+//
+uint32_t video_clock_divider(uint32_t sys_hz, double sm_hz, float *error_ppm)
+{
+    double div = sys_hz / sm_hz;
+    uint32_t fixed = (uint32_t)(div * 256 + 0.5); // 16.8 fixed point
+
+    if (fixed < 256)
+        fixed = 256; // Can't go faster than the system clock
+    if (fixed > 0xFFFFFF)
+        fixed = 0xFFFFFF;
+    *error_ppm = (float)((sys_hz * 256.0 / fixed - sm_hz) / sm_hz * 1e6);
+    return fixed << 8;
+}
+
+// Plan the dividers for a timing
+// - sys_hz: System clock, from clock_get_hz(clk_sys)
+// - t: The timing descriptor
+// - plan: Filled in with the dividers and their errors
+//
+void video_clock_plan(uint32_t sys_hz, const struct video_timing *t, struct video_clock_plan *plan)
+{
+    double entry_hz = VIDEO_SYNC_ENTRIES / (t->line_us * 1e-6); // Sync table entries per second
+
+    plan->sys_hz = sys_hz;
+    plan->sync_clkdiv = video_clock_divider(sys_hz, entry_hz * VIDEO_SYNC_CYCLES, &plan->sync_error_ppm);
+    for (int i = 0; i < 3; i++)
+    {
+        plan->pixel_clkdiv[i] = video_clock_divider(sys_hz, t->pixel_hz[i] * VIDEO_PIXEL_CYCLES, &plan->pixel_error_ppm[i]);
+    }
+    plan->subcarrier_clkdiv = video_clock_divider(sys_hz, t->subcarrier_hz * VIDEO_SUBCARRIER_CYCLES, &plan->subcarrier_error_ppm);
+}
+
+// Find the system clock that gets the subcarrier closest to exact
+// - subcarrier_hz: Colour subcarrier frequency
+// - min_hz, max_hz: Range of system clocks to consider
+// - vco_hz, postdiv1, postdiv2: Set to the PLL settings for it, for set_sys_clock_pll
+// Returns
+// - The system clock, or 0 if none in the range can be made; the fastest wins a tie
+//
+uint32_t video_clock_pick_sys(double subcarrier_hz, uint32_t min_hz, uint32_t max_hz, uint32_t *vco_hz, int *postdiv1, int *postdiv2)
+{
+    uint32_t best = 0;
+    float best_error = 0;
+
+    for (int fbdiv = 16; fbdiv <= 320; fbdiv++)
+    {
+        uint32_t vco = XOSC_HZ * fbdiv;
+        if (vco < 750000000u || vco > 1600000000u) // VCO range of the RP2040 PLL
+            continue;
+        for (int pd1 = 1; pd1 <= 7; pd1++)
+        {
+            for (int pd2 = 1; pd2 <= pd1; pd2++)
+            {
+                uint32_t sys = vco / (pd1 * pd2);
+                if (sys < min_hz || sys > max_hz || vco % (pd1 * pd2))
+                    continue;
+                float error;
+                video_clock_divider(sys, subcarrier_hz * VIDEO_SUBCARRIER_CYCLES, &error);
+                error = fabsf(error);
+                if (best == 0 || error < best_error || (error == best_error && sys > best))
+                {
+                    best = sys;
+                    best_error = error;
+                    *vco_hz = vco;
+                    *postdiv1 = pd1;
+                    *postdiv2 = pd2;
+                }
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,45 @@
+//
+// Title:	        Pico-mposite Video Clock
+// Description:		Clock divider planning for the video state machines
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Works out the PIO clock dividers for the sync, pixel and AD724 subcarrier state machines
+// from the actual system clock, and how far out each resulting frequency is. This file has no
+// SDK dependencies, so it can be built on a host
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+
+#include "video_timing.h"
+
+#define VIDEO_SYNC_CYCLES 48    // PIO cycles per sync table entry in cvideo_sync
+#define VIDEO_PIXEL_CYCLES 3    // PIO cycles per pixel in cvideo_data
+#define VIDEO_SUBCARRIER_CYCLES 2 // PIO cycles per subcarrier period in ad724_clock
+
+struct video_clock_plan
+{
+    uint32_t sys_hz;            // System clock the plan is for
+    uint32_t sync_clkdiv;       // Dividers in SMx_CLKDIV format: 16 bit integer part, 8 bit fraction, in bits 31 to 8
+    uint32_t pixel_clkdiv[3];   // For modes 0, 1 and 2
+    uint32_t subcarrier_clkdiv;
+    float sync_error_ppm;       // How far out each resulting frequency is, in parts per million
+    float pixel_error_ppm[3];
+    float subcarrier_error_ppm;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    uint32_t video_clock_divider(uint32_t sys_hz, double sm_hz, float *error_ppm);
+    void video_clock_plan(uint32_t sys_hz, const struct video_timing *t, struct video_clock_plan *plan);
+    uint32_t video_clock_pick_sys(double subcarrier_hz, uint32_t min_hz, uint32_t max_hz, uint32_t *vco_hz, int *postdiv1, int *postdiv2);
+#ifdef __cplusplus
+}
+#endif
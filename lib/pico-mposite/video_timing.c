@@ -0,0 +1,283 @@
+//
+// Title:	        Pico-mposite Video Timing
+// Description:		Video timing descriptors and sync table generation
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Modinfo:
+// 18/10/2026:      Added interlaced timings
+//                  Clocks given as frequencies rather than dividers
+
+#include <string.h>
+
+#include "video_timing.h"
+
+// PAL(ish): 258 progressive lines, 240 of them active
+//
+const struct video_timing video_timing_pal = {
+    .name = "PAL",
+    .total_lines = 258,
+    .vsync_long = 2,
+    .vsync_long_short = 1,
+    .vsync_short = 2,
+    .border_top = 13,
+    .active_lines = 240,
+    .hsync_entries = 2,
+    .back_porch_entries = 3,
+    .border_start = 6,
+    .vsync_long_entries = 15,
+    .vsync_short_entries = 1,
+    .line_us = 64.512f,                                // At 250MHz, the sync divider of 10.5 these were tuned as
+    .pixel_hz = {6944444.0f, 6218905.0f, 14880952.0f}, // And pixel dividers of 12.0, 13.4 and 5.6
+    .subcarrier_hz = 4433618.75f,
+};
+
+// NTSC(ish): 249 progressive lines, 240 of them active
+//
+const struct video_timing video_timing_ntsc = {
+    .name = "NTSC",
+    .total_lines = 249,
+    .vsync_long = 6,
+    .vsync_long_short = 0,
+    .vsync_short = 3,
+    .border_top = 0,
+    .active_lines = 240,
+    .hsync_entries = 2,
+    .back_porch_entries = 2,
+    .border_start = 6,
+    .vsync_long_entries = 15,
+    .vsync_short_entries = 1,
+    .line_us = 66.970f,                                // At 250MHz, the sync divider of 10.9 these were tuned as
+    .pixel_hz = {5020080.0f, 5952381.0f, 16534392.0f}, // And pixel dividers of 16.6, 14.0 and 5.04
+    .subcarrier_hz = 3579545.45f,
+};
+
+// PAL interlaced: 625 lines a frame, 288 active in each field
+//
+const struct video_timing video_timing_pal_576i = {
+    .name = "PAL 576i",
+    .interlaced = 1,
+    .total_lines = 625,
+    .vsync_long = 5,
+    .vsync_short = 5,
+    .border_top = 16,
+    .active_lines = 288,
+    .hsync_entries = 2,
+    .back_porch_entries = 3,
+    .border_start = 6,
+    .vsync_long_entries = 15,
+    .vsync_short_entries = 1,
+    .line_us = 64.512f,
+    .pixel_hz = {6944444.0f, 6218905.0f, 14880952.0f},
+    .subcarrier_hz = 4433618.75f,
+};
+
+// NTSC interlaced: 525 lines a frame, 240 active in each field
+//
+const struct video_timing video_timing_ntsc_480i = {
+    .name = "NTSC 480i",
+    .interlaced = 1,
+    .total_lines = 525,
+    .vsync_long = 6,
+    .vsync_short = 6,
+    .border_top = 10,
+    .active_lines = 240,
+    .hsync_entries = 2,
+    .back_porch_entries = 2,
+    .border_start = 6,
+    .vsync_long_entries = 15,
+    .vsync_short_entries = 1,
+    .line_us = 66.970f,
+    .pixel_hz = {5020080.0f, 5952381.0f, 16534392.0f},
+    .subcarrier_hz = 3579545.45f,
+};
+
+// Check a timing descriptor
+// - t: The timing descriptor
+// Returns
+// - 0 if it can be generated, -1 if not
+//
+int video_timing_validate(const struct video_timing *t)
+{
+    const int half = VIDEO_SYNC_ENTRIES / 2;
+
+    if (t->total_lines < 1 || t->total_lines > VIDEO_TIMING_MAX_LINES)
+        return -1;
+    if (t->active_lines < 1 || t->active_lines > VIDEO_TIMING_MAX_ACTIVE)
+        return -1;
+    if (t->vsync_long < 0 || t->vsync_long_short < 0 || t->vsync_short < 0 || t->border_top < 0)
+        return -1;
+    if (t->interlaced)
+    {
+        if (!(t->total_lines & 1) || t->vsync_long < 1 || t->vsync_short < 1)
+            return -1;
+        if ((2 * t->vsync_short + t->vsync_long + 1) / 2 * 2 + 1 + 2 * (t->border_top + t->active_lines) > t->total_lines) // In half lines
+            return -1;
+    }
+    else if (t->vsync_long + t->vsync_long_short + t->vsync_short + t->border_top + t->active_lines > t->total_lines)
+        return -1;
+    if (t->hsync_entries < 1 || t->back_porch_entries < 0)
+        return -1;
+    if (t->hsync_entries + t->back_porch_entries >= VIDEO_SYNC_ENTRIES - 1) // Needs a zero to start the pixels, and the border at the end
+        return -1;
+    if (t->border_start < t->hsync_entries || t->border_start >= VIDEO_SYNC_ENTRIES)
+        return -1;
+    if (t->vsync_long_entries < 1 || t->vsync_long_entries >= half || t->vsync_short_entries < 1 || t->vsync_short_entries >= half)
+        return -1;
+    if (t->line_us <= 0 || t->subcarrier_hz <= 0)
+        return -1;
+    for (int i = 0; i < 3; i++)
+    {
+        if (t->pixel_hz[i] <= 0)
+            return -1;
+    }
+    return 0;
+}
+
+// Fill half a line of vertical sync
+//
+static void vsync_half(unsigned short *p, int pulse, const struct video_sync_levels *levels)
+{
+    for (int i = 0; i < VIDEO_SYNC_ENTRIES / 2; i++)
+    {
+        p[i] = i < pulse ? levels->vslo : levels->vshi;
+    }
+}
+
+// Fill half a line of blank, starting with a line sync pulse if it's the first half
+//
+static void blank_half(unsigned short *p, int first, const struct video_timing *t, const struct video_sync_levels *levels)
+{
+    for (int i = 0; i < VIDEO_SYNC_ENTRIES / 2; i++)
+    {
+        p[i] = first && i < t->hsync_entries ? levels->hslo : levels->hshi;
+    }
+}
+
+// Get what a half line of an interlaced frame holds
+// - t: The timing descriptor
+// - h: Half line number, from 0
+// Returns
+// - 'S' for a short pulse, 'L' for a long pulse, or 'N' for part of a normal line
+//
+static char half_line(const struct video_timing *t, int h)
+{
+    int k = h < t->total_lines ? h : h - t->total_lines; // Half line in the field
+    if (k < t->vsync_short)
+        return 'S';
+    if (k < t->vsync_short + t->vsync_long)
+        return 'L';
+    if (k < 2 * t->vsync_short + t->vsync_long)
+        return 'S';
+    return 'N';
+}
+
+// Build the line schedule for an interlaced frame
+//
+static void build_interlaced_schedule(const struct video_timing *t, unsigned char *schedule)
+{
+    for (int line = 0; line < t->total_lines; line++)
+    {
+        char a = half_line(t, line * 2);
+        char b = half_line(t, line * 2 + 1);
+        unsigned char type = LINE_BORDER;
+        if (a == 'L')
+            type = b == 'L' ? LINE_VSYNC_LONG : LINE_VSYNC_LONG_SHORT;
+        else if (a == 'S')
+            type = b == 'L' ? LINE_VSYNC_SHORT_LONG : b == 'S' ? LINE_VSYNC_SHORT : LINE_SHORT_BLANK;
+        else if (b == 'S')
+            type = LINE_BLANK_SHORT;
+        schedule[line + 1] = type;
+    }
+
+    // The first field shows the even rows, so the second has to start half a line lower. Whether
+    // rounding its vsync up to a whole line does that depends on the parity of the vsync length,
+    // so place it from the first field instead
+    //
+    int end = 2 * t->vsync_short + t->vsync_long;       // Half line after the first field's vsync
+    int start = (end + 1) / 2 + t->border_top + 1;      // First whole line after it, then the border
+    for (int field = 0; field < 2; field++)
+    {
+        int line = start + field * (t->total_lines + 1) / 2; // total_lines + 1 half lines later
+        for (int i = 0; i < t->active_lines; i++)
+            schedule[line + i] = LINE_ACTIVE;
+    }
+}
+
+// Generate the sync tables and line schedule for a timing
+// - t: The timing descriptor
+// - levels: The sync table values for the board
+// - tables: Filled in with the tables
+// Returns
+// - 0 if successful, -1 if the descriptor is invalid
+//
+int video_timing_build(const struct video_timing *t, const struct video_sync_levels *levels, struct video_sync_tables *tables)
+{
+    const int half = VIDEO_SYNC_ENTRIES / 2;
+
+    if (video_timing_validate(t) < 0)
+    {
+        return -1;
+    }
+
+    // Active lines: the sync pulse and back porch, zeros while the pixels are output, then
+    // the border colour to finish the line
+    //
+    for (int i = 0; i < VIDEO_SYNC_ENTRIES; i++)
+    {
+        if (i < t->hsync_entries)
+            tables->hsync[i] = levels->hslo;
+        else if (i < t->hsync_entries + t->back_porch_entries)
+            tables->hsync[i] = levels->hshi;
+        else
+            tables->hsync[i] = 0;
+    }
+    tables->hsync[VIDEO_SYNC_ENTRIES - 1] = levels->bord;
+
+    // Border lines
+    //
+    for (int i = 0; i < VIDEO_SYNC_ENTRIES; i++)
+    {
+        if (i < t->hsync_entries)
+            tables->border[i] = levels->hslo;
+        else if (i < t->border_start)
+            tables->border[i] = levels->hshi;
+        else
+            tables->border[i] = levels->bord;
+    }
+
+    // Vertical sync lines, each made of two half lines
+    //
+    vsync_half(&tables->vsync_ll[0], t->vsync_long_entries, levels);
+    vsync_half(&tables->vsync_ll[half], t->vsync_long_entries, levels);
+    vsync_half(&tables->vsync_ls[0], t->vsync_long_entries, levels);
+    vsync_half(&tables->vsync_ls[half], t->vsync_short_entries, levels);
+    vsync_half(&tables->vsync_ss[0], t->vsync_short_entries, levels);
+    vsync_half(&tables->vsync_ss[half], t->vsync_short_entries, levels);
+    vsync_half(&tables->vsync_sl[0], t->vsync_short_entries, levels);
+    vsync_half(&tables->vsync_sl[half], t->vsync_long_entries, levels);
+    vsync_half(&tables->short_blank[0], t->vsync_short_entries, levels);
+    blank_half(&tables->short_blank[half], 0, t, levels);
+    blank_half(&tables->blank_short[0], 1, t, levels);
+    vsync_half(&tables->blank_short[half], t->vsync_short_entries, levels);
+
+    // The line schedule
+    //
+    int line = 1;
+    memset(tables->schedule, LINE_BORDER, sizeof(tables->schedule));
+    if (t->interlaced)
+    {
+        build_interlaced_schedule(t, tables->schedule);
+        return 0;
+    }
+    for (int i = 0; i < t->vsync_long; i++)
+        tables->schedule[line++] = LINE_VSYNC_LONG;
+    for (int i = 0; i < t->vsync_long_short; i++)
+        tables->schedule[line++] = LINE_VSYNC_LONG_SHORT;
+    for (int i = 0; i < t->vsync_short; i++)
+        tables->schedule[line++] = LINE_VSYNC_SHORT;
+    line += t->border_top;
+    for (int i = 0; i < t->active_lines; i++)
+        tables->schedule[line++] = LINE_ACTIVE;
+    return 0;
+}
@@ -0,0 +1,94 @@
+//
+// Title:	        Pico-mposite Video Timing
+// Description:		Video timing descriptors and sync table generation
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// A timing descriptor sets out the lines of a field and the shape of the sync pulses. The
+// sync tables that cvideo_sync plays out, and the schedule saying which table each line uses,
+// are generated from it. This file has no SDK dependencies, so it can be built on a host
+//
+// Modinfo:
+// 18/10/2026:      Added interlaced timings
+//                  Clocks given as frequencies rather than dividers, see video_clock.h
+
+#pragma once
+
+#define VIDEO_SYNC_ENTRIES 32       // 2us entries in a 64us sync table
+#define VIDEO_TIMING_MAX_LINES 625  // Longest frame supported
+#define VIDEO_TIMING_MAX_ACTIVE 288 // Most active lines in a field
+
+enum video_line_type
+{
+    LINE_BORDER,           // Line sync, then the border colour
+    LINE_ACTIVE,           // Line sync, then pixel data
+    LINE_VSYNC_LONG,       // Two long (broad) sync pulses
+    LINE_VSYNC_LONG_SHORT, // A long then a short sync pulse
+    LINE_VSYNC_SHORT,      // Two short (equalising) sync pulses
+    LINE_VSYNC_SHORT_LONG, // A short then a long sync pulse; interlaced only
+    LINE_SHORT_BLANK,      // A short sync pulse, then half a blank line; interlaced only
+    LINE_BLANK_SHORT,      // Half a blank line, then a short sync pulse; interlaced only
+};
+
+// For an interlaced timing the vsync is counted in half lines rather than lines. Each field starts
+// with vsync_short short pulses, vsync_long long pulses and another vsync_short short pulses; the
+// second field starts half way through a line, so its lines fall between those of the first
+//
+struct video_timing
+{
+    const char *name;
+    int interlaced;          // Set for two interlaced fields a frame
+    int total_lines;         // Lines in a field, or lines in a frame if interlaced (which must be odd)
+    int vsync_long;          // Lines of long sync pulses, starting at line 1; half lines if interlaced
+    int vsync_long_short;    // Lines of a long then a short sync pulse, following those; not used if interlaced
+    int vsync_short;         // Lines of short sync pulses, following those; half lines before and after if interlaced
+    int border_top;          // Border lines between the vsync and the active area, in each field
+    int active_lines;        // Lines of pixels in each field; any lines left at the bottom are border
+    int hsync_entries;       // Table entries of the line sync pulse
+    int back_porch_entries;  // Table entries between the sync pulse and the pixels
+    int border_start;        // First table entry of a border line to show the border colour
+    int vsync_long_entries;  // Table entries of a long sync pulse, in each 16 entry half line
+    int vsync_short_entries; // Table entries of a short sync pulse, in each 16 entry half line
+    float line_us;           // Line period in microseconds; sets the length of a sync table entry
+    float pixel_hz[3];       // Pixel rate in modes 0, 1 and 2
+    float subcarrier_hz;     // Colour subcarrier for the AD724
+};
+
+struct video_sync_levels // Sync table values, which depend on the board
+{
+    unsigned short hslo; // Line sync pulse
+    unsigned short hshi; // Back porch
+    unsigned short vslo; // Vertical sync pulse
+    unsigned short vshi; // Between vertical sync pulses
+    unsigned short bord; // Border, including the BORD flag
+};
+
+struct video_sync_tables
+{
+    unsigned short hsync[VIDEO_SYNC_ENTRIES];
+    unsigned short border[VIDEO_SYNC_ENTRIES];
+    unsigned short vsync_ll[VIDEO_SYNC_ENTRIES];
+    unsigned short vsync_ls[VIDEO_SYNC_ENTRIES];
+    unsigned short vsync_ss[VIDEO_SYNC_ENTRIES];
+    unsigned short vsync_sl[VIDEO_SYNC_ENTRIES];
+    unsigned short short_blank[VIDEO_SYNC_ENTRIES];
+    unsigned short blank_short[VIDEO_SYNC_ENTRIES];
+    unsigned char schedule[VIDEO_TIMING_MAX_LINES + 1]; // Line type for each line, numbered from 1
+};
+
+extern const struct video_timing video_timing_pal;
+extern const struct video_timing video_timing_ntsc;
+extern const struct video_timing video_timing_pal_576i;
+extern const struct video_timing video_timing_ntsc_480i;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int video_timing_validate(const struct video_timing *t);
+    int video_timing_build(const struct video_timing *t, const struct video_sync_levels *levels, struct video_sync_tables *tables);
+#ifdef __cplusplus
+}
+#endif
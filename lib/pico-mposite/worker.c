@@ -0,0 +1,77 @@
+//
+// Title:	        Pico-mposite Core 1 Worker
+// Description:		Job runner on core 1
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Core 1 sits in a loop taking a job and its argument from the FIFO and pushing the result back,
+// so several modules can share it. Until initialise_worker is called, worker_start runs the job
+// straight away on the calling core, so callers work the same either way
+//
+// Modinfo:
+#include <Arduino.h>
+
+#include "pico/multicore.h"
+
+#include "worker.h"
+
+bool worker_launched;   // Set once core 1 is running the worker
+uint32_t worker_result; // Result of a job run on the calling core
+
+// The core 1 loop
+//
+static void worker_main(void)
+{
+    while (true)
+    {
+        worker_job_t job = (worker_job_t)(uintptr_t)multicore_fifo_pop_blocking();
+        uint32_t arg = multicore_fifo_pop_blocking();
+        multicore_fifo_push_blocking(job(arg));
+    }
+}
+
+// Start the worker on core 1; core 1 must not be running anything else
+//
+void initialise_worker(void)
+{
+    if (!worker_launched)
+    {
+        multicore_launch_core1(worker_main);
+        worker_launched = true;
+    }
+}
+
+// Check whether jobs run on core 1
+//
+bool worker_running(void)
+{
+    return worker_launched;
+}
+
+// Start a job; only one can be in progress, so call worker_wait before the next
+// - job: The job
+// - arg: Its argument
+//
+void worker_start(worker_job_t job, uint32_t arg)
+{
+    if (worker_launched)
+    {
+        multicore_fifo_push_blocking((uint32_t)(uintptr_t)job);
+        multicore_fifo_push_blocking(arg);
+    }
+    else
+    {
+        worker_result = job(arg);
+    }
+}
+
+// Wait for the job to finish
+// Returns
+// - The job's result
+//
+uint32_t worker_wait(void)
+{
+    return worker_launched ? multicore_fifo_pop_blocking() : worker_result;
+}
@@ -0,0 +1,35 @@
+//
+// Title:	        Pico-mposite Core 1 Worker
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Runs jobs on core 1 for the modules that split their work between the cores
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// A job for core 1
+// - arg: Argument passed to worker_start
+// Returns
+// - Result for worker_wait
+//
+typedef uint32_t (*worker_job_t)(uint32_t arg);
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    void initialise_worker(void);
+    bool worker_running(void);
+    void worker_start(worker_job_t job, uint32_t arg);
+    uint32_t worker_wait(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -36,14 +36,17 @@ static inline pio_sm_config ad724_clock_program_get_default_config(uint offset)
 }
 
 #include "hardware/pio.h"
-// freq: desired output frequency (e.g. 4430000 for PAL, 3579545 for NTSC)
+#include "hardware/clocks.h"
+// freq: desired output frequency (e.g. 4433619 for PAL, 3579545 for NTSC)
+// The divider is worked out from the actual system clock, rounded to the nearest 1/256
 void ad724_clock_init(PIO pio, uint sm, uint offset, uint pin, float freq) {
     pio_gpio_init(pio, pin);
     pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, true);
     pio_sm_config c = ad724_clock_program_get_default_config(offset);
     sm_config_set_out_pins(&c, pin, 1);
     sm_config_set_set_pins(&c, pin, 1);
-    sm_config_set_clkdiv(&c, (float) (250000000.0f / (freq * 2.0f)) );
+    uint32_t div = (uint32_t) (clock_get_hz(clk_sys) * 256.0 / (freq * 2.0) + 0.5);
+    sm_config_set_clkdiv_int_frac(&c, div >> 8, div & 0xFF);
     pio_sm_init(pio, sm, offset, &c);
     pio_sm_set_enabled(pio, sm, true);
 }
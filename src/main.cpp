@@ -14,6 +14,17 @@
 #include "bitmaps.h"
 #include "graphics.h"
 #include "cvideo.h"
+#include "fractal.h"
+#include "mesh3d.h"
+#include "sbuffer.h"
+#include "capture.h"
+#include "command.h"
+#include "palette.h"
+#include "dither.h"
+#include "blend.h"
+#include "feedback.h"
+#include "worker.h"
+#include "profile.h"
 #include "ad724_clock.pio.h"
 
 #if VIDEO_NTSC
@@ -24,6 +35,35 @@
 #define AD724_CLOCK_PIN 29
 #define AD724_CLOCK_SM 2
 
+#define TORUS_MAJOR 16 // Segments around the ring
+#define TORUS_MINOR 12 // Segments around the tube
+#define TORUS_VERTICES (TORUS_MAJOR * TORUS_MINOR)
+
+short torus_x[TORUS_VERTICES];
+short torus_y[TORUS_VERTICES];
+short torus_z[TORUS_VERTICES];
+unsigned short torus_faces[TORUS_VERTICES * 6];
+unsigned char torus_colours[TORUS_VERTICES * 2];
+
+#if opt_capture
+// Send capture data over USB serial, as much as fits without waiting
+//
+int capture_usb_write(const uint8_t *data, int length)
+{
+    int n = Serial.availableForWrite();
+    return Serial.write(data, n < length ? n : length);
+}
+#endif
+
+#if opt_profile
+// Send a line of the profiler report over USB serial
+//
+void profile_usb_print(const char *s)
+{
+    Serial.print(s);
+}
+#endif
+
 void setup()
 {
     // Initialize the AD724 clock on pin 29
@@ -33,20 +73,276 @@ void setup()
 
     initialise_cvideo(); // Initialise the composite video stuff
     set_mode(1);
+#if opt_capture || opt_command || opt_profile
+    Serial.begin(115200);
+#endif
+#if opt_capture
+    capture_start(capture_usb_write);
+#endif
+#if opt_command
+    initialise_command();
+#endif
 }
 
 void loop()
 {
+#if opt_command
+    static uint8_t buffer[256]; // Draw whatever the host sends instead of the demo
+    static int length, taken;   // Bytes in buffer, and how many command_feed has taken
+    while (true)
+    {
+        int n = Serial.available();
+        if (taken == length && n > 0)
+        {
+            length = Serial.readBytes(buffer, n < (int)sizeof(buffer) ? n : sizeof(buffer));
+            taken = 0;
+        }
+        n = command_feed(buffer + taken, length - taken);
+        taken += n;
+        if (n == 0)
+        {
+            break; // Nothing more, or the display list is full; the host waits until a frame is drawn
+        }
+    }
+    command_update();
+#if opt_capture
+    capture_update();
+#endif
+    return;
+#endif
      draw_screen_border(col_white);
     draw_random(col_white);
+#if opt_profile
+    profile_overlay(8, 8, 176);
+#endif
 
+    swap_video_buffer(); // Flip is latched at the start of the next frame
+#if opt_capture
+    capture_update();
+#endif
+#if opt_profile
+    if (profile_frame_count % 50 == 0) // About once a second
+    {
+        profile_report(profile_usb_print);
+    }
+#endif
 
-    wait_vblank();
-    swap_video_buffer();
     clearScreen(0);
 }
 
 
+// Demo: Mandlebrot set, zooming in
+// Each view gets a few frames of iterations before the zoom moves on, so it stays smooth and
+// the picture sharpens whenever the zoom is slow enough
+//
+void demo_mandlebrot()
+{
+    struct fractal_view view = {FRACTAL_FIX(-0.743644), FRACTAL_FIX(0.131826), FRACTAL_FIX(3.0 / 320), 64};
+
+    initialise_fractal();
+    set_border(col_black);
+    while (view.step > 16) // Q4.28 runs out of precision past here
+    {
+        fractal_start(&view);
+        for (int i = 0; i < 4 && !fractal_update(60000); i++)
+        {
+            wait_vblank();
+        }
+        view.step -= view.step / 32;
+        view.max_iter = view.max_iter < 512 ? view.max_iter + 1 : 512;
+    }
+}
+
+// Build the torus for demo_mesh
+// - r1: Radius of the ring
+// - r2: Radius of the tube
+//
+void make_torus(int r1, int r2)
+{
+    for (int i = 0; i < TORUS_MAJOR; i++)
+    {
+        for (int j = 0; j < TORUS_MINOR; j++)
+        {
+            int a = i * 360 / TORUS_MAJOR;
+            int b = j * 360 / TORUS_MINOR;
+            int r = r1 + (r2 * cosTable[b] >> 10);
+            int v = i * TORUS_MINOR + j;
+            int i1 = (i + 1) % TORUS_MAJOR;
+            int j1 = (j + 1) % TORUS_MINOR;
+            unsigned short *f = &torus_faces[v * 6];
+
+            torus_x[v] = r * cosTable[a] >> 10;
+            torus_y[v] = r * sinTable[a] >> 10;
+            torus_z[v] = r2 * sinTable[b] >> 10;
+            f[0] = v; // Two triangles per quad, clockwise from outside
+            f[1] = i1 * TORUS_MINOR + j1;
+            f[2] = i1 * TORUS_MINOR + j;
+            f[3] = v;
+            f[4] = i * TORUS_MINOR + j1;
+            f[5] = i1 * TORUS_MINOR + j1;
+            torus_colours[v * 2] = torus_colours[v * 2 + 1] = (i + j) & 1 ? col_grey : col_white;
+        }
+    }
+}
+
+// Demo: Spinning torus
+// - frames: Number of frames to run for
+// - flags: MESH_FILLED and/or MESH_WIREFRAME, or MESH_SBUFFER
+//
+void demo_mesh(int frames, int flags)
+{
+    struct mesh torus = {TORUS_VERTICES, torus_x, torus_y, torus_z, TORUS_VERTICES * 2, torus_faces, torus_colours};
+    struct mesh_camera camera = {(short)(screenWidth / 2), (short)(screenHeight / 2), 256};
+    struct mesh_matrix m;
+
+    make_torus(120, 50);
+    for (int i = 0; i < frames; i++)
+    {
+        clearScreen(0);
+        sbuf_begin();
+        mesh_rotation(&m, i, i * 2, i * 3);
+        m.t[2] = 500;
+        mesh_draw(&torus, &m, &camera, flags);
+        sbuf_flush(); // Nothing to draw unless MESH_SBUFFER was set
+        swap_video_buffer();
+    }
+}
+
+// Demo: Colour cycling
+// The rings are drawn once as palette indices; after that only the palette changes, fading in
+// from black and then cycling
+// - frames: Number of frames to run for
+//
+void demo_palette(int frames)
+{
+    unsigned char base[256];
+    unsigned char black[256];
+    unsigned char shown[256];
+
+    for (int i = 0; i < 256; i++)
+    {
+        int r = abs((i & 255) - 128) >> 4; // Three triangle waves, a third of the way round apart
+        int g = abs(((i + 85) & 255) - 128) >> 4;
+        int b = abs(((i + 170) & 255) - 128) >> 4;
+#if opt_colour == 0
+        base[i] = colour_base + r * 2;
+#else
+        base[i] = rgb(r > 7 ? 7 : r, g > 7 ? 7 : g, b > 7 ? 7 : b);
+#endif
+    }
+    palette_fill(black, col_black);
+    for (int buffer = 0; buffer < 2; buffer++) // Both buffers, so swapping doesn't matter
+    {
+        for (int y = 0; y < screenHeight; y++)
+        {
+            for (int x = 0; x < screenWidth; x++)
+            {
+                int dx = x - screenWidth / 2;
+                int dy = y - screenHeight / 2;
+                drawPixel(x, y, (dx * dx + dy * dy) >> 6);
+            }
+        }
+        swap_video_buffer();
+    }
+    for (int i = 0; i < frames; i++)
+    {
+        palette_rotate(base, 0, 256, 1);
+        palette_blend(shown, black, base, i < 64 ? i * 4 : 256);
+        set_palette(shown); // Latched at the start of the next frame
+        wait_vblank();
+    }
+    set_palette(NULL);
+}
+
+// Demo: True colour gradients
+// Each row is generated in 24 bit colour and dithered straight into the back buffer
+// - frames: Number of frames to run for
+// - method: DITHER_FLOYD_STEINBERG or DITHER_ORDERED
+//
+void demo_dither(int frames, int method)
+{
+    static struct dither d;
+    uint8_t row[VIDEO_MAX_WIDTH * 3];
+
+    for (int i = 0; i < frames; i++)
+    {
+        dither_start(&d, screenWidth, opt_colour ? DITHER_COLOUR : DITHER_MONO, method, colour_base);
+        for (int y = 0; y < screenHeight; y++)
+        {
+            for (int x = 0; x < screenWidth; x++)
+            {
+                uint8_t *p = &row[x * 3];
+                p[0] = x * 255 / screenWidth;
+                p[1] = y * 255 / screenHeight;
+                p[2] = 128 + (sinTable[(x + y + i * 4) % 360] >> 3);
+            }
+            dither_row(&d, row, &screen_bitmap_next[y * screenWidth]);
+        }
+        swap_video_buffer();
+    }
+}
+
+// Demo: Blend modes
+// Three boxes circle each other, added together, under a half strength band and over a
+// multiplied triangle
+// - frames: Number of frames to run for
+//
+void demo_blend(int frames)
+{
+#if opt_colour == 0
+    unsigned char colours[3] = {5, 5, 5};
+#else
+    unsigned char colours[3] = {col_red, col_green, col_blue};
+#endif
+    int cx = screenWidth / 2;
+    int cy = screenHeight / 2;
+
+    for (int i = 0; i < frames; i++)
+    {
+        fillRect(0, 0, screenWidth, screenHeight, col_grey);
+        fillTriangleBlend(cx, 10, screenWidth - 20, screenHeight - 10, 20, screenHeight - 10, colours[0], BLEND_MULTIPLY, BLEND_OPAQUE);
+        fillRect(0, 0, screenWidth, screenHeight / 4, col_black);
+        for (int j = 0; j < 3; j++)
+        {
+            int a = (i * 2 + j * 120) % 360;
+            int x = cx + (50 * cosTable[a] >> 10);
+            int y = cy + (40 * sinTable[a] >> 10);
+            fillRectBlend(x - 45, y - 35, 90, 70, colours[j], BLEND_ADD, BLEND_OPAQUE);
+        }
+        fillRectBlend(0, cy - 12, screenWidth, 24, col_white, BLEND_ALPHA, 8);
+        swap_video_buffer();
+    }
+}
+
+// Demo: Video feedback
+// Each frame is the last one zoomed in, turned and faded a little, with a new box drawn over it
+// - frames: Number of frames to run for
+//
+void demo_feedback(int frames)
+{
+    unsigned char identity[256];
+    unsigned char black[256];
+    unsigned char decay[256];
+    struct feedback f;
+
+    initialise_worker();
+    palette_identity(identity);
+    palette_fill(black, col_black);
+    palette_blend(decay, identity, black, 24); // Rounds down, so old trails fade out altogether
+    feedback_transform(&f, 264, 2, 0, 0);
+    f.edge = FEEDBACK_MIRROR;
+    f.decay = decay;
+    for (int i = 0; i < frames; i++)
+    {
+        feedback_warp(&f);
+        int a = (i * 3) % 360;
+        int x = screenWidth / 2 + (80 * cosTable[a] >> 10);
+        int y = screenHeight / 2 + (60 * sinTable[(a * 2) % 360] >> 10);
+        fillRect(x - 6, y - 6, 12, 12, i & 32 ? col_white : col_grey);
+        swap_video_buffer();
+    }
+}
+
 void demo_horizontal_sweep()
 {
     static int y = 80;
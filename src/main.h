@@ -7,6 +7,12 @@
 // Modinfo:
 // 20/02/2022:      Added demo_terminal
 // 01/03/2022:      Added colour to the demos
+// 18/10/2026:      demo_mandlebrot uses the fixed point fractal renderer
+//                  Added demo_mesh
+//                  Added demo_palette
+//                  Added demo_dither
+//                  Added demo_blend
+//                  Added demo_feedback
 
 #pragma once
 
@@ -33,6 +39,11 @@ int main(void);
 void demo_splash(void);
 void demo_spinny_cube(void);
 void demo_mandlebrot(void);
+void demo_mesh(int frames, int flags);
+void demo_palette(int frames);
+void demo_dither(int frames, int method);
+void demo_blend(int frames);
+void demo_feedback(int frames);
 
 void render_spinny_cube(int xo, int yo, double the, double psi, double phi, bool filled);
 void render_mandlebrot(void);
@@ -0,0 +1,18 @@
+//
+// Title:	        Pico-mposite Native Test Stubs
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Stands in for the Arduino core when a library module is built on the host for the native tests
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
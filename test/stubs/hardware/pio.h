@@ -0,0 +1,20 @@
+//
+// Title:	        Pico-mposite Native Test Stubs
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Just the SDK types cvideo.h uses, so it can be included by the native tests
+//
+// Modinfo:
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+typedef void *PIO;
+typedef void (*irq_handler_t)(void);
@@ -0,0 +1,295 @@
+//
+// Title:	        Pico-mposite Capture Tests
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Streams frames from a stubbed screen through capture_update into a pipe, decodes them with
+// tools/capture_decode.c running in a child process, and checks the PPM files it writes against
+// what was on the screen. The writers take what the pipe will, or only a few bytes at a time.
+// A stream with malformed rows checks that the decoder drops them
+//
+// Modinfo:
+#include <unity.h>
+#include <stdio.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "capture.c"
+
+#define main capture_decode_main
+#include "capture_decode.c"
+#undef main
+
+#define FRAMES 6
+
+// The parts of cvideo.c that capture.c uses
+//
+unsigned char *screen_bitmap;
+int screenWidth;
+int screenHeight;
+int scroll_x;
+int scroll_y;
+
+static unsigned char bitmap[VIDEO_MAX_WIDTH * 240];
+static unsigned char shown[FRAMES][240][VIDEO_MAX_WIDTH]; // Each frame as it should come out
+static int shown_width[FRAMES];
+static int shown_height[FRAMES];
+
+static int pipe_fd; // The write end, which doesn't block
+
+static int write_pipe(const uint8_t *data, int length)
+{
+    int n = write(pipe_fd, data, length);
+    return n < 0 ? 0 : n; // Full
+}
+
+static int write_part(const uint8_t *data, int length)
+{
+    static int calls;
+    if (++calls % 3 == 0)
+    {
+        return 0; // Busy
+    }
+    return write_pipe(data, length < 5 ? length : 5);
+}
+
+void setUp(void)
+{
+    screen_bitmap = bitmap;
+    screenWidth = 320;
+    screenHeight = 240;
+    scroll_x = scroll_y = 0;
+    srand(1);
+}
+
+void tearDown(void)
+{
+}
+
+// Draw a frame: rows of one colour, noise, copies of the row above and a mixture, then change a
+// few rows, scroll, leave it alone, and change the mode
+//
+static void draw(int f)
+{
+    int size = screenWidth * screenHeight;
+    switch (f)
+    {
+    case 0:
+    case 5:
+        if (f == 5)
+        {
+            screenWidth = 256;
+            size = screenWidth * screenHeight;
+        }
+        for (int i = 0; i < size; i++)
+        {
+            int x = i % screenWidth, y = i / screenWidth;
+            switch (y & 3)
+            {
+            case 0:
+                bitmap[i] = y;
+                break;
+            case 1:
+                bitmap[i] = rand();
+                break;
+            case 2:
+                bitmap[i] = bitmap[i - screenWidth];
+                break;
+            default:
+                bitmap[i] = x && rand() % 4 ? bitmap[i - 1] : rand();
+                break;
+            }
+        }
+        break;
+    case 1:
+        memset(&bitmap[10 * screenWidth], 0x55, 3 * screenWidth);
+        bitmap[200 * screenWidth + 17] ^= 0xff;
+        break;
+    case 2:
+        scroll_y = 7;
+        break;
+    case 4:
+        memset(bitmap, 0, size);
+        break;
+    }
+    for (int y = 0; y < screenHeight; y++)
+    {
+        memcpy(shown[f][y], &bitmap[screen_row(y) * screenWidth], screenWidth);
+    }
+    shown_width[f] = screenWidth;
+    shown_height[f] = screenHeight;
+}
+
+// Check a PPM file written by capture_decode
+//
+static void check_frame(const char *prefix, int f)
+{
+    char name[256];
+    snprintf(name, sizeof(name), "%s%05d.ppm", prefix, f);
+    FILE *ppm = fopen(name, "rb");
+    TEST_ASSERT_NOT_NULL(ppm);
+    int w = 0, h = 0, max = 0;
+    TEST_ASSERT_EQUAL_INT(3, fscanf(ppm, "P6 %d %d %d", &w, &h, &max));
+    fgetc(ppm);
+    TEST_ASSERT_EQUAL_INT(shown_width[f], w);
+    TEST_ASSERT_EQUAL_INT(shown_height[f], h);
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            uint8_t p = shown[f][y][x], rgb[3], expected[3];
+            TEST_ASSERT_EQUAL_INT(3, fread(rgb, 1, 3, ppm));
+            if (opt_colour)
+            {
+                expected[0] = (p & 7) * 255 / 7;
+                expected[1] = (p >> 3 & 7) * 255 / 7;
+                expected[2] = (p >> 6) * 255 / 3;
+            }
+            else
+            {
+                int v = p < 0x10 ? 0 : p > 0x1f ? 15 : p - 0x10;
+                expected[0] = expected[1] = expected[2] = v * 17;
+            }
+            TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected, rgb, 3, name);
+        }
+    }
+    fclose(ppm);
+    unlink(name);
+}
+
+static char dir[32];
+static char prefix[64];
+
+// Start capture_decode in a child process, reading from a pipe, and point pipe_fd at the pipe
+// Returns
+// - The child's process ID
+//
+static pid_t start_decoder(void)
+{
+    int fds[2];
+
+    strcpy(dir, "/tmp/capture_testXXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    snprintf(prefix, sizeof(prefix), "%s/frame_", dir);
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+    signal(SIGPIPE, SIG_IGN);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        char *argv[] = {"capture_decode", "-", prefix, NULL};
+        close(fds[1]);
+        dup2(fds[0], 0);
+        capture_decode_main(3, argv); // Exits at the end of the stream
+        _exit(1);
+    }
+    close(fds[0]);
+    pipe_fd = fds[1];
+    fcntl(pipe_fd, F_SETFL, O_NONBLOCK);
+    return pid;
+}
+
+// End the stream, and check the decoder wrote the frames expected and no more
+// - pid: The decoder
+// - frames: Number of frames, in shown
+//
+static void finish_decoder(pid_t pid, int frames)
+{
+    char name[256];
+    int status;
+
+    close(pipe_fd);
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    for (int f = 0; f < frames; f++)
+    {
+        check_frame(prefix, f);
+    }
+    snprintf(name, sizeof(name), "%s%05d.ppm", prefix, frames);
+    TEST_ASSERT_FALSE(access(name, F_OK) == 0);
+    rmdir(dir);
+}
+
+// Stream FRAMES frames through a writer to capture_decode and check them
+//
+static void run(capture_write_t writer)
+{
+    pid_t pid = start_decoder();
+    capture_start(writer);
+    for (int f = 0; f < FRAMES; f++)
+    {
+        draw(f);
+        while (capture_update())
+        {
+        }
+    }
+    capture_stop();
+    finish_decoder(pid, FRAMES);
+}
+
+void test_capture_pipe(void)
+{
+    run(write_pipe);
+}
+
+void test_capture_partial_writes(void)
+{
+    run(write_part);
+}
+
+// Send all of some bytes down the pipe
+//
+static void send(const uint8_t *data, int length)
+{
+    for (int i = 0; i < length;)
+    {
+        i += write_pipe(data + i, length - i);
+    }
+}
+
+void test_capture_malformed_rows(void)
+{
+    static uint8_t stream[2048];
+    int n = 0;
+    uint8_t header[] = {CAPTURE_SYNC, 'F', 0, 0, 8, 0, 4, 0, opt_colour};
+    uint8_t good[] = {CAPTURE_SYNC, 'R', 0, 0, 2, 0, 134, 0x07};     // A run of 8
+    uint8_t literal[] = {CAPTURE_SYNC, 'R', 1, 0, 3, 0, 7, 1, 2};    // 8 literals, but only 2 there
+    uint8_t run[] = {CAPTURE_SYNC, 'R', 2, 0, 1, 0, 134};            // A run without its byte
+    uint8_t end[] = {CAPTURE_SYNC, 'E', 0, 0};
+
+    memcpy(stream + n, header, sizeof(header)), n += sizeof(header);
+    memcpy(stream + n, good, sizeof(good)), n += sizeof(good);
+    memcpy(stream + n, literal, sizeof(literal)), n += sizeof(literal);
+    memcpy(stream + n, run, sizeof(run)), n += sizeof(run);
+    uint8_t big[] = {CAPTURE_SYNC, 'R', 3, 0, MAX_WIDTH * 2 & 255, MAX_WIDTH * 2 >> 8}; // As long as a row can be
+    memcpy(stream + n, big, sizeof(big)), n += sizeof(big);
+    for (int i = 0; i < MAX_WIDTH * 2 - 2; i += 2) // Single literals, then 128 literals off the end
+    {
+        stream[n++] = 0;
+        stream[n++] = 0x11;
+    }
+    stream[n++] = 127;
+    stream[n++] = 0x11;
+    memcpy(stream + n, end, sizeof(end)), n += sizeof(end);
+
+    pid_t pid = start_decoder();
+    send(stream, n);
+    memset(shown[0], 0, sizeof(shown[0])); // Only the good row is decoded
+    memset(shown[0][0], 0x07, 8);
+    shown_width[0] = 8;
+    shown_height[0] = 4;
+    finish_decoder(pid, 1);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_capture_pipe);
+    RUN_TEST(test_capture_partial_writes);
+    RUN_TEST(test_capture_malformed_rows);
+    return UNITY_END();
+}
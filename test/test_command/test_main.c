@@ -0,0 +1,370 @@
+//
+// Title:	        Pico-mposite Command Protocol Tests
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Sends packets built by tools/command_client.c through command_feed, with the graphics
+// primitives stubbed out to count what gets drawn; text, which command.c draws itself, is checked
+// in the back buffer. Covers the client's demo stream, bad CRCs, oversized lengths, truncated
+// commands, a full display list holding the host back, and frames bigger than the list
+//
+// Modinfo:
+#include <unity.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "command.c"
+#include "charset.c"
+
+#define main command_client_main
+#include "command_client.c"
+#undef main
+
+// The parts of cvideo.c and graphics.c that command.c uses, counting what is drawn
+//
+unsigned char *screen_bitmap_next;
+int screenWidth = 320;
+int screenHeight = 240;
+
+static unsigned char back_buffer[320 * 240];
+
+static struct
+{
+    int lines;
+    int fill_rects;
+    int flips;
+    int other;
+    int last_fill_rect[5];
+} drawn;
+
+void fillRect(short x, short y, short w, short h, char color)
+{
+    drawn.fill_rects++;
+    drawn.last_fill_rect[0] = x;
+    drawn.last_fill_rect[1] = y;
+    drawn.last_fill_rect[2] = w;
+    drawn.last_fill_rect[3] = h;
+    drawn.last_fill_rect[4] = (unsigned char)color;
+}
+
+void drawLine(short x0, short y0, short x1, short y1, char color) { drawn.lines++; }
+void swap_video_buffer() { drawn.flips++; }
+
+void set_border(unsigned char colour) { drawn.other++; }
+void set_scroll(int x, int y) { drawn.other++; }
+void drawPixel(short x, short y, unsigned char c) { drawn.other++; }
+void drawHLine(short x, short y, short w, unsigned char color) { drawn.other++; }
+void drawVLine(short x, short y, short h, unsigned char color) { drawn.other++; }
+void drawLineThickness(short x0, short y0, short x1, short y1, char unsigned color, short thickness) { drawn.other++; }
+void drawRect(short x, short y, short w, short h, char color) { drawn.other++; }
+void drawRectThickness(short x, short y, short w, short h, char color, short thickness) { drawn.other++; }
+void drawRectCenter(short x, short y, short w, short h, char color) { drawn.other++; }
+void fillRectCenter(short x, short y, short w, short h, char color) { drawn.other++; }
+void drawRoundRect(short x, short y, short w, short h, short r, char color) { drawn.other++; }
+void fillRoundRect(short x, short y, short w, short h, short r, char color) { drawn.other++; }
+void drawCircle(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency) { drawn.other++; }
+void fillCircle(short x0, short y0, short r, char color) { drawn.other++; }
+void filledElipsisTransparency(short x0, short y0, short w, short h, char color, int transparency) { drawn.other++; }
+void drawTriangle(short x0, short y0, short x1, short y1, short x2, short y2, char color) { drawn.other++; }
+void fillTriangle(short x0, short y0, short x1, short y1, short x2, short y2, char color) { drawn.other++; }
+void drawRectRotated(short x, short y, short w, short h, char color, uint8_t thickness, int transparency, short angleDeg) { drawn.other++; }
+void drawFillRectRotated(short x, short y, short w, short h, char color, int transparency, short angleDeg) { drawn.other++; }
+void drawCircleRotated(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency, short angleDeg) { drawn.other++; }
+void filledElipsisRotated(short x0, short y0, short w, short h, char color, int transparency, short angleDeg) { drawn.other++; }
+void drawRectTransparency(short x, short y, short w, short h, char color, uint8_t thickness, int transparency) { drawn.other++; }
+void fillRectTransparency(short x, short y, short w, short h, char color, int transparency) { drawn.other++; }
+void drawRectCenterThickness(short x, short y, short w, short h, char color, short thickness) { drawn.other++; }
+void drawStar(short x0, short y0, short w, short h, char color, uint8_t thickness, int transparency) { drawn.other++; }
+void drawCharCustomSize(short x, short y, unsigned char c, char color, char bg, short widthSize, short heightSize, short transparency) { drawn.other++; }
+void drawImage(int xPosition, int yPosition, int targetWidth, int targetHeight, unsigned char *bitmapData, int bitmapWidth, int bitmapHeight, int color, int bgColor, bool doItFast, int transparency) { drawn.other++; }
+
+static FILE *stream; // Where command_client writes
+static uint8_t sent[1 << 16];
+
+void setUp(void)
+{
+    memset(&drawn, 0, sizeof(drawn));
+    memset(back_buffer, 0xee, sizeof(back_buffer));
+    screen_bitmap_next = back_buffer;
+    initialise_command();
+    stream = tmpfile();
+    fd = fileno(stream);
+    length = 0;
+    srand(1);
+}
+
+void tearDown(void)
+{
+    fclose(stream);
+}
+
+// Take what command_client has written since last time
+// Returns
+// - Number of bytes in sent
+//
+static int take(void)
+{
+    int n = lseek(fd, 0, SEEK_CUR);
+    lseek(fd, 0, SEEK_SET);
+    TEST_ASSERT_EQUAL_INT(n, read(fd, sent, n));
+    TEST_ASSERT_EQUAL_INT(0, ftruncate(fd, 0));
+    lseek(fd, 0, SEEK_SET);
+    return n;
+}
+
+// Check a string in the back buffer, as far as it is on screen
+//
+static void check_text(int x, int y, const char *s, int fg, int bg)
+{
+    for (int i = 0; s[i]; i++)
+    {
+        for (int row = 0; row < 8; row++)
+        {
+            for (int col = 0; col < 8; col++)
+            {
+                int px = x + i * 8 + col, py = y + row;
+                if (px < 0 || px >= screenWidth || py < 0 || py >= screenHeight)
+                {
+                    continue;
+                }
+                int on = charset[(s[i] - 32) * 8 + row] & 0x80 >> col;
+                TEST_ASSERT_EQUAL_INT_MESSAGE(colour_base + (on ? fg : bg), back_buffer[py * screenWidth + px], s);
+            }
+        }
+    }
+}
+
+// Feed bytes in pieces of random sizes, as they would come off the serial port
+// Returns
+// - Bytes taken, which stops short if command_feed does
+//
+static int feed(const uint8_t *data, int n)
+{
+    for (int i = 0; i < n;)
+    {
+        int k = 1 + rand() % 64;
+        k = k < n - i ? k : n - i;
+        int taken = command_feed(data + i, k);
+        i += taken;
+        if (taken < k)
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+// A packet with a rectangle in it
+//
+static int rect_packet(void)
+{
+    cmd_fill_rect(1, -2, 3, 4, 5);
+    flush();
+    return take();
+}
+
+// A packet filling the payload with rectangles
+//
+#define RECTS_PER_PACKET (CMD_MAX_PAYLOAD / 10)
+
+static void add_full_packet(void)
+{
+    for (int i = 0; i < RECTS_PER_PACKET; i++)
+    {
+        cmd_fill_rect(i, i, 8, 8, i);
+    }
+    flush();
+}
+
+static int full_packet(void)
+{
+    add_full_packet();
+    return take();
+}
+
+void test_client_demo(void)
+{
+    char name[] = "/tmp/command_testXXXXXX";
+    int frames = 3, count = 500;
+    close(mkstemp(name));
+    char f[8], c[8];
+    snprintf(f, sizeof(f), "%d", frames);
+    snprintf(c, sizeof(c), "%d", count);
+    char *argv[] = {"command_client", name, f, c, NULL};
+    int saved = fd;
+    TEST_ASSERT_EQUAL_INT(0, command_client_main(4, argv));
+    close(fd);
+    fd = saved;
+
+    FILE *demo = fopen(name, "rb");
+    TEST_ASSERT_NOT_NULL(demo);
+    int n = fread(sent, 1, sizeof(sent), demo);
+    fclose(demo);
+    unlink(name);
+    TEST_ASSERT_GREATER_THAN_INT(0, n);
+
+    for (int i = 0; i < n;) // As the main loop would
+    {
+        int k = 1 + rand() % 64;
+        k = k < n - i ? k : n - i;
+        i += command_feed(sent + i, k);
+        command_update();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, command_stats.errors);
+    TEST_ASSERT_EQUAL_UINT32(frames, command_stats.frames);
+    TEST_ASSERT_EQUAL_INT(frames, drawn.flips);
+    TEST_ASSERT_EQUAL_INT(frames * count / 2, drawn.lines);
+    TEST_ASSERT_EQUAL_INT(frames * (count / 2 + 1), drawn.fill_rects); // And a clear each frame
+    TEST_ASSERT_EQUAL_INT(0, drawn.other);
+    check_text(0, 0, "Frame 2", 255, 0);
+}
+
+void test_bad_crc(void)
+{
+    int n = rect_packet();
+    sent[4] ^= 1; // A bit of the payload
+    feed(sent, n);
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.errors);
+    TEST_ASSERT_EQUAL_UINT32(0, command_stats.packets);
+
+    n = rect_packet();
+    sent[n - 1] ^= 0x80; // And of the CRC
+    feed(sent, n);
+    TEST_ASSERT_EQUAL_UINT32(2, command_stats.errors);
+
+    n = rect_packet(); // A good one is still picked up
+    feed(sent, n);
+    cmd_flip();
+    feed(sent, take());
+    TEST_ASSERT_EQUAL_UINT32(2, command_stats.packets);
+    TEST_ASSERT_TRUE(command_update());
+    TEST_ASSERT_EQUAL_INT(1, drawn.fill_rects);
+    int expected[5] = {1, -2, 3, 4, 5};
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, drawn.last_fill_rect, 5);
+}
+
+void test_oversized_length(void)
+{
+    uint8_t header[3] = {CMD_SYNC, (CMD_MAX_PAYLOAD + 1) & 255, (CMD_MAX_PAYLOAD + 1) >> 8};
+    command_feed(header, 3);
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.errors);
+
+    int n = full_packet(); // The largest allowed, straight after
+    TEST_ASSERT_EQUAL_INT(3 + RECTS_PER_PACKET * 10 + 2, n);
+    feed(sent, n);
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.errors);
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.packets);
+}
+
+void test_truncated_commands(void)
+{
+    cmd_line(0, 0, 10, 10, 1); // A good command, then one cut short
+    op(CMD_LINE, 9);
+    h(0), h(0), h(10);
+    flush();
+    feed(sent, take());
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.errors);
+
+    op(CMD_TEXT, 10); // Text shorter than its length
+    h(0), h(0), b(1), b(0), b(10);
+    memcpy(&payload[length], "abc", 3);
+    length += 3;
+    flush();
+    feed(sent, take());
+    TEST_ASSERT_EQUAL_UINT32(2, command_stats.errors);
+
+    b(CMD_OPCODES); // No such command
+    flush();
+    feed(sent, take());
+    TEST_ASSERT_EQUAL_UINT32(3, command_stats.errors);
+
+    cmd_flip(); // None of which were kept
+    feed(sent, take());
+    TEST_ASSERT_TRUE(command_update());
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.packets);
+    TEST_ASSERT_EQUAL_INT(0, drawn.lines);
+    TEST_ASSERT_EQUAL_INT(0xee, back_buffer[0]);
+    TEST_ASSERT_EQUAL_INT(1, drawn.flips);
+}
+
+void test_text(void)
+{
+    cmd_text(100, 50, 7, 1, "Hello");
+    cmd_text(-4, 236, 2, 3, "Edge"); // Clipped on the left and the bottom
+    cmd_text(316, -3, 4, 5, "Xy");   // And on the right and the top
+    cmd_flip();
+    feed(sent, take());
+    TEST_ASSERT_TRUE(command_update());
+    check_text(100, 50, "Hello", 7, 1);
+    check_text(-4, 236, "Edge", 2, 3);
+    check_text(316, -3, "Xy", 4, 5);
+    TEST_ASSERT_EQUAL_INT(0xee, back_buffer[49 * screenWidth + 100]);
+    TEST_ASSERT_EQUAL_INT(0xee, back_buffer[50 * screenWidth + 140]);
+}
+
+void test_list_full(void)
+{
+    cmd_fill_rect(0, 0, 1, 1, 1); // A frame waiting to be drawn
+    cmd_flip();
+    feed(sent, take());
+
+    int packets = 2 * CMD_LIST_SIZE / CMD_MAX_PAYLOAD; // Then more than the list holds
+    for (int i = 0; i < packets; i++)
+    {
+        add_full_packet();
+    }
+    int n = take();
+    int taken = feed(sent, n);
+    TEST_ASSERT_TRUE(taken < n);
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.waits);
+    TEST_ASSERT_EQUAL_INT(0, command_feed(sent + taken, n - taken)); // Nothing more until there's room
+    TEST_ASSERT_EQUAL_UINT32(0, command_stats.flushes);
+    TEST_ASSERT_EQUAL_INT(0, drawn.fill_rects);
+
+    TEST_ASSERT_TRUE(command_update()); // Draws the frame, then the next as far as it has got to make room for the packet held back
+    TEST_ASSERT_EQUAL_INT(1, drawn.flips);
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.flushes);
+    TEST_ASSERT_EQUAL_INT(n - taken, feed(sent + taken, n - taken));
+
+    cmd_flip(); // Nothing was lost
+    feed(sent, take());
+    TEST_ASSERT_TRUE(command_update());
+    TEST_ASSERT_EQUAL_UINT32(0, command_stats.errors);
+    TEST_ASSERT_EQUAL_UINT32(1 + packets + 1, command_stats.packets);
+    TEST_ASSERT_EQUAL_INT(1 + packets * RECTS_PER_PACKET, drawn.fill_rects);
+    TEST_ASSERT_EQUAL_INT(2, drawn.flips);
+    TEST_ASSERT_FALSE(command_update());
+}
+
+void test_frame_bigger_than_list(void)
+{
+    int packets = 3 * CMD_LIST_SIZE / CMD_MAX_PAYLOAD;
+    for (int i = 0; i < packets; i++)
+    {
+        feed(sent, full_packet());
+    }
+    cmd_flip();
+    feed(sent, take());
+    TEST_ASSERT_TRUE(command_update());
+    TEST_ASSERT_GREATER_THAN_INT(0, command_stats.flushes);
+    TEST_ASSERT_EQUAL_UINT32(0, command_stats.waits);
+    TEST_ASSERT_EQUAL_UINT32(0, command_stats.errors);
+    TEST_ASSERT_EQUAL_INT(packets * RECTS_PER_PACKET, drawn.fill_rects);
+    TEST_ASSERT_EQUAL_INT(1, drawn.flips);
+    TEST_ASSERT_EQUAL_UINT32(1, command_stats.frames);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_client_demo);
+    RUN_TEST(test_bad_crc);
+    RUN_TEST(test_oversized_length);
+    RUN_TEST(test_truncated_commands);
+    RUN_TEST(test_text);
+    RUN_TEST(test_list_full);
+    RUN_TEST(test_frame_bigger_than_list);
+    return UNITY_END();
+}
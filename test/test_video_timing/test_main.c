@@ -0,0 +1,176 @@
+//
+// Title:	        Pico-mposite Video Timing Tests
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Checks the tables generated for PAL and NTSC against the static tables and line switch they
+// replaced, and that the interlaced timings put the fields in the right order
+//
+// Modinfo:
+#include <unity.h>
+
+#include "video_timing.c"
+
+#define HSLO 0x4200 // The colour board's levels
+#define HSHI 0x4000
+#define VSLO 0x4100
+#define VSHI 0x4000
+#define BORD 0x8000
+
+static const struct video_sync_levels levels = {HSLO, HSHI, VSLO, VSHI, BORD};
+static struct video_sync_tables tables;
+
+// The tables from before video_timing.c
+//
+static const unsigned short ntsc_hsync[VIDEO_SYNC_ENTRIES] = {
+    HSLO, HSLO, HSHI, HSHI, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, BORD};
+
+static const unsigned short pal_hsync[VIDEO_SYNC_ENTRIES] = {
+    HSLO, HSLO, HSHI, HSHI, HSHI, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, BORD};
+
+static const unsigned short border[VIDEO_SYNC_ENTRIES] = {
+    HSLO, HSLO, HSHI, HSHI, HSHI, HSHI, BORD,
+    BORD, BORD, BORD, BORD, BORD, BORD, BORD,
+    BORD, BORD, BORD, BORD, BORD, BORD, BORD,
+    BORD, BORD, BORD, BORD, BORD, BORD, BORD,
+    BORD, BORD, BORD, BORD};
+
+static const unsigned short vsync_ll[VIDEO_SYNC_ENTRIES] = {
+    VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSHI,
+    VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSHI};
+
+static const unsigned short vsync_ss[VIDEO_SYNC_ENTRIES] = {
+    VSLO, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI,
+    VSLO, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI};
+
+static const unsigned short vsync_ls[VIDEO_SYNC_ENTRIES] = {
+    VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSLO, VSHI,
+    VSLO, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI, VSHI};
+
+// The line switch from the old cvideo_dma_handler
+//
+static unsigned char pal_line(int line)
+{
+    switch (line)
+    {
+    case 1 ... 2:
+        return LINE_VSYNC_LONG;
+    case 3:
+        return LINE_VSYNC_LONG_SHORT;
+    case 4 ... 5:
+        return LINE_VSYNC_SHORT;
+    case 6 ... 18:
+        return LINE_BORDER;
+    default:
+        return LINE_ACTIVE;
+    }
+}
+
+static unsigned char ntsc_line(int line)
+{
+    if (line >= 1 && line <= 6)
+        return LINE_VSYNC_LONG;
+    if (line >= 7 && line <= 9)
+        return LINE_VSYNC_SHORT;
+    return LINE_ACTIVE;
+}
+
+void setUp(void)
+{
+    memset(&tables, 0xff, sizeof(tables));
+}
+
+void tearDown(void)
+{
+}
+
+static void check_common(void)
+{
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(border, tables.border, VIDEO_SYNC_ENTRIES);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(vsync_ll, tables.vsync_ll, VIDEO_SYNC_ENTRIES);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(vsync_ss, tables.vsync_ss, VIDEO_SYNC_ENTRIES);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(vsync_ls, tables.vsync_ls, VIDEO_SYNC_ENTRIES);
+}
+
+void test_pal_matches_old_tables(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, video_timing_build(&video_timing_pal, &levels, &tables));
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(pal_hsync, tables.hsync, VIDEO_SYNC_ENTRIES);
+    check_common();
+    for (int line = 1; line <= video_timing_pal.total_lines; line++)
+    {
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(pal_line(line), tables.schedule[line], "PAL schedule");
+    }
+}
+
+void test_ntsc_matches_old_tables(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, video_timing_build(&video_timing_ntsc, &levels, &tables));
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(ntsc_hsync, tables.hsync, VIDEO_SYNC_ENTRIES);
+    check_common();
+    for (int line = 1; line <= video_timing_ntsc.total_lines; line++)
+    {
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(ntsc_line(line), tables.schedule[line], "NTSC schedule");
+    }
+}
+
+// Each field of an interlaced frame has its active lines in one run inside the field, and the
+// second field's run starts half a line lower, relative to its vsync, than the first's, so that
+// it shows the odd rows
+//
+static void check_field_order(const struct video_timing *t)
+{
+    int start[2] = {0, 0}, count[2] = {0, 0};
+
+    TEST_ASSERT_EQUAL_INT(0, video_timing_build(t, &levels, &tables));
+    for (int line = 1; line <= t->total_lines; line++)
+    {
+        int field = (line - 1) * 2 >= t->total_lines; // Which field the line starts in
+        if (tables.schedule[line] != LINE_ACTIVE)
+            continue;
+        if (count[field]++ == 0)
+            start[field] = line;
+        TEST_ASSERT_EQUAL_INT_MESSAGE(start[field] + count[field] - 1, line, "Active lines not in one run");
+    }
+    TEST_ASSERT_EQUAL_INT(t->active_lines, count[0]);
+    TEST_ASSERT_EQUAL_INT(t->active_lines, count[1]);
+
+    int vsync = 2 * t->vsync_short + t->vsync_long; // Half lines
+    int first = (start[0] - 1) * 2;                  // Where each run starts, in half lines from the start of its field
+    int second = (start[1] - 1) * 2 - t->total_lines;
+    TEST_ASSERT_GREATER_OR_EQUAL_INT(vsync, first);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(first + 1, second, "Second field isn't half a line below the first");
+    TEST_ASSERT_LESS_OR_EQUAL_INT(t->total_lines, start[1] + t->active_lines - 1);
+}
+
+void test_pal_576i_field_order(void)
+{
+    check_field_order(&video_timing_pal_576i);
+}
+
+void test_ntsc_480i_field_order(void)
+{
+    check_field_order(&video_timing_ntsc_480i);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pal_matches_old_tables);
+    RUN_TEST(test_ntsc_matches_old_tables);
+    RUN_TEST(test_pal_576i_field_order);
+    RUN_TEST(test_ntsc_480i_field_order);
+    return UNITY_END();
+}
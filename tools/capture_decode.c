@@ -0,0 +1,190 @@
+//
+// Title:	        Pico-mposite Capture Decoder
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Decodes the stream from capture.c into a sequence of PPM files. Build and run on the host:
+//
+// cc -O2 -o capture_decode capture_decode.c
+// ./capture_decode /dev/ttyACM0 frame_
+//
+// The input can be a serial device, which is put into raw mode, a file, or - for stdin
+//
+// Modinfo:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define CAPTURE_SYNC 0xa5
+#define MAX_WIDTH 640
+#define MAX_HEIGHT 576
+
+static uint8_t frame[MAX_HEIGHT][MAX_WIDTH]; // The screen as last received
+static int width, height, colour;
+static FILE *in;
+
+// Read bytes, exiting at the end of the stream
+//
+static void get(uint8_t *p, int n)
+{
+    if (fread(p, 1, n, in) != (size_t)n)
+    {
+        exit(0);
+    }
+}
+
+static int get16(void)
+{
+    uint8_t b[2];
+    get(b, 2);
+    return b[0] | b[1] << 8;
+}
+
+// Write the screen out as a PPM
+//
+static void save(const char *prefix, int number)
+{
+    char name[256];
+    snprintf(name, sizeof(name), "%s%05d.ppm", prefix, number);
+    FILE *f = fopen(name, "wb");
+    if (f == NULL)
+    {
+        perror(name);
+        exit(1);
+    }
+    fprintf(f, "P6\n%d %d\n255\n", width, height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t p = frame[y][x], rgb[3];
+            if (colour)
+            { // 3 bits red, 3 bits green, 2 bits blue, from the bottom
+                rgb[0] = (p & 7) * 255 / 7;
+                rgb[1] = (p >> 3 & 7) * 255 / 7;
+                rgb[2] = (p >> 6) * 255 / 3;
+            }
+            else
+            { // 16 levels above the black level at 0x10
+                int v = p < 0x10 ? 0 : p > 0x1f ? 15 : p - 0x10;
+                rgb[0] = rgb[1] = rgb[2] = v * 17;
+            }
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+}
+
+// Decode a row packet into the screen
+// - y: Row
+// - length: Bytes of packed row
+// Returns
+// - 0 if successful, -1 if the row is bad, in which case the screen is left as it was
+//
+static int decode_row(int y, int length)
+{
+    static uint8_t data[MAX_WIDTH * 2];
+    uint8_t row[MAX_WIDTH];
+    if (y >= height || length > (int)sizeof(data))
+    {
+        return -1;
+    }
+    get(data, length);
+    memcpy(row, frame[y], width);
+    int x = 0;
+    for (int i = 0; i < length;)
+    {
+        int c = data[i++];
+        int n = c < 128 ? c + 1 : c - 126;
+        if (c < 128 ? i + n > length : i >= length)
+        {
+            return -1; // Runs past the end of the packet
+        }
+        for (int j = 0; j < n && x < width; j++, x++)
+        {
+            uint8_t b = c < 128 ? data[i + j] : data[i];
+            row[x] = y ? b ^ frame[y - 1][x] : b;
+        }
+        i += c < 128 ? n : 1;
+    }
+    memcpy(frame[y], row, width);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *prefix = argc > 2 ? argv[2] : "frame_";
+    int saved = 0;
+
+    if (argc < 2 || strcmp(argv[1], "-") == 0)
+    {
+        in = stdin;
+    }
+    else
+    {
+        int fd = open(argv[1], O_RDONLY | O_NOCTTY);
+        if (fd < 0)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+        struct termios t;
+        if (tcgetattr(fd, &t) == 0)
+        {
+            cfmakeraw(&t);
+            tcsetattr(fd, TCSANOW, &t);
+        }
+        in = fdopen(fd, "rb");
+    }
+
+    while (1)
+    {
+        uint8_t b[2];
+        get(b, 1);
+        if (b[0] != CAPTURE_SYNC)
+        {
+            continue; // Look for the start of a packet
+        }
+        get(b + 1, 1);
+        if (b[1] == 'F')
+        {
+            get16(); // Frame number
+            int w = get16(), h = get16();
+            get(b, 1);
+            if (w > MAX_WIDTH || h > MAX_HEIGHT || (w & 3))
+            {
+                continue;
+            }
+            if (w != width || h != height)
+            {
+                memset(frame, 0, sizeof(frame));
+            }
+            width = w;
+            height = h;
+            colour = b[0];
+        }
+        else if (b[1] == 'R')
+        {
+            int y = get16();
+            int length = get16();
+            if (decode_row(y, length) < 0)
+            {
+                fprintf(stderr, "Bad row %d\n", y);
+            }
+        }
+        else if (b[1] == 'E')
+        {
+            get16();
+            if (width && height)
+            {
+                save(prefix, saved++);
+            }
+        }
+    }
+}
@@ -0,0 +1,182 @@
+//
+// Title:	        Pico-mposite Command Client
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Reference host side of the command protocol in command.h. Builds packets of drawing commands
+// and sends them down a serial device; run it for a demo of random lines and boxes:
+//
+// cc -O2 -o command_client command_client.c
+// ./command_client /dev/ttyACM0 [frames] [primitives per frame]
+//
+// The device can also be a file, or - for stdout, to capture a stream for testing
+//
+// Modinfo:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define CMD_SYNC 0x7e
+#define CMD_MAX_PAYLOAD 2048
+
+#define CMD_FLIP 0x01
+#define CMD_CLEAR 0x02
+#define CMD_LINE 0x13
+#define CMD_FILL_RECT 0x17
+#define CMD_TEXT 0x30
+
+static uint8_t payload[CMD_MAX_PAYLOAD];
+static int length;
+static int fd;
+
+// Work out a CRC-16/CCITT, as command_crc
+//
+static uint16_t crc16(const uint8_t *data, int n)
+{
+    uint16_t crc = 0xffff;
+    for (int i = 0; i < n; i++)
+    {
+        crc ^= data[i] << 8;
+        for (int b = 0; b < 8; b++)
+        {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Send the packet built so far
+//
+static void flush(void)
+{
+    if (length == 0)
+    {
+        return;
+    }
+    uint16_t crc = crc16(payload, length);
+    uint8_t header[3] = {CMD_SYNC, length & 255, length >> 8};
+    uint8_t trailer[2] = {crc & 255, crc >> 8};
+    if (write(fd, header, 3) != 3 || write(fd, payload, length) != length || write(fd, trailer, 2) != 2)
+    {
+        perror("write");
+        exit(1);
+    }
+    length = 0;
+}
+
+// Start a command, sending the packet first if it won't fit
+// - opcode: The command
+// - size: Bytes of arguments and data that follow
+//
+static void op(int opcode, int size)
+{
+    if (length + 1 + size > CMD_MAX_PAYLOAD)
+    {
+        flush();
+    }
+    payload[length++] = opcode;
+}
+
+static void h(int v)
+{
+    payload[length++] = v & 255;
+    payload[length++] = (v >> 8) & 255;
+}
+
+static void b(int v)
+{
+    payload[length++] = v;
+}
+
+// The commands used by the demo; the others follow the same pattern
+//
+static void cmd_clear(int c)
+{
+    op(CMD_CLEAR, 1);
+    b(c);
+}
+
+static void cmd_line(int x0, int y0, int x1, int y1, int c)
+{
+    op(CMD_LINE, 9);
+    h(x0), h(y0), h(x1), h(y1), b(c);
+}
+
+static void cmd_fill_rect(int x, int y, int w, int hh, int c)
+{
+    op(CMD_FILL_RECT, 9);
+    h(x), h(y), h(w), h(hh), b(c);
+}
+
+static void cmd_text(int x, int y, int fg, int bg, const char *s)
+{
+    int n = strlen(s) > 255 ? 255 : strlen(s);
+    op(CMD_TEXT, 7 + n);
+    h(x), h(y), b(fg), b(bg), b(n);
+    memcpy(&payload[length], s, n);
+    length += n;
+}
+
+static void cmd_flip(void)
+{
+    op(CMD_FLIP, 0);
+    flush(); // The frame can be drawn once this arrives
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s device [frames] [primitives]\n", argv[0]);
+        return 1;
+    }
+    int frames = argc > 2 ? atoi(argv[2]) : 100;
+    int count = argc > 3 ? atoi(argv[3]) : 500;
+
+    if (strcmp(argv[1], "-") == 0)
+    {
+        fd = 1;
+    }
+    else
+    {
+        fd = open(argv[1], O_WRONLY | O_NOCTTY | O_CREAT, 0644);
+        if (fd < 0)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+        struct termios t;
+        if (tcgetattr(fd, &t) == 0)
+        {
+            cfmakeraw(&t);
+            tcsetattr(fd, TCSANOW, &t);
+        }
+    }
+    srand(1);
+    for (int f = 0; f < frames; f++)
+    {
+        cmd_clear(0);
+        for (int i = 0; i < count; i++)
+        {
+            if (i & 1)
+            {
+                cmd_line(rand() % 320, rand() % 240, rand() % 320, rand() % 240, rand() & 255);
+            }
+            else
+            {
+                cmd_fill_rect(rand() % 320, rand() % 240, rand() % 32, rand() % 32, rand() & 255);
+            }
+        }
+        char s[32];
+        snprintf(s, sizeof(s), "Frame %d", f);
+        cmd_text(0, 0, 255, 0, s);
+        cmd_flip();
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+//
+// Title:	        Pico-mposite Image Converter
+// Created:	        18/10/2026
+// Last Updated:	18/10/2026
+//
+// Description:
+//
+// Converts a 24 bit binary PPM (P6) into screen pixels with the dithering in dither.c, a row at a
+// time. Build and run on the host:
+//
+// cc -O2 -I lib/pico-mposite -o convert_image tools/convert_image.c lib/pico-mposite/dither.c
+// ./convert_image [-m] [-o] [-n name] image.ppm image.h
+//
+// -m converts for the mono board, -o uses the ordered dither instead of Floyd-Steinberg, and -n
+// names the array. An output file ending in .h gets a C array with the width and height; anything
+// else gets the raw pixels, as CMD_IMAGE in command.h takes them
+//
+// Modinfo:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#include "dither.h"
+
+#define MONO_BASE 0x10 // colour_base on the mono board
+
+// Read a number from a PPM header, skipping whitespace and comments
+//
+static int ppm_number(FILE *f)
+{
+    int c, n = 0;
+    while ((c = fgetc(f)) != EOF && (isspace(c) || c == '#'))
+    {
+        if (c == '#')
+        {
+            while ((c = fgetc(f)) != EOF && c != '\n')
+                ;
+        }
+    }
+    if (!isdigit(c))
+    {
+        return -1;
+    }
+    for (; isdigit(c); c = fgetc(f))
+    {
+        n = n * 10 + c - '0';
+    }
+    return n; // The single whitespace after the number has been read
+}
+
+int main(int argc, char **argv)
+{
+    int format = DITHER_COLOUR;
+    int method = DITHER_FLOYD_STEINBERG;
+    const char *name = "image";
+    int i;
+
+    for (i = 1; i < argc && argv[i][0] == '-' && argv[i][1]; i++)
+    {
+        if (!strcmp(argv[i], "-m"))
+            format = DITHER_MONO;
+        else if (!strcmp(argv[i], "-o"))
+            method = DITHER_ORDERED;
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            name = argv[++i];
+        else
+            break;
+    }
+    if (argc - i != 2)
+    {
+        fprintf(stderr, "usage: %s [-m] [-o] [-n name] image.ppm output\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[i], "rb");
+    if (in == NULL || fgetc(in) != 'P' || fgetc(in) != '6')
+    {
+        fprintf(stderr, "%s: not a binary PPM\n", argv[i]);
+        return 1;
+    }
+    int width = ppm_number(in);
+    int height = ppm_number(in);
+    int maxval = ppm_number(in);
+    static struct dither d;
+    if (height <= 0 || maxval != 255 || dither_start(&d, width, format, method, format == DITHER_MONO ? MONO_BASE : 0) < 0)
+    {
+        fprintf(stderr, "%s: must be 8 bits per channel and at most %d pixels wide\n", argv[i], DITHER_MAX_WIDTH);
+        return 1;
+    }
+
+    const char *path = argv[i + 1];
+    size_t len = strlen(path);
+    int header = len > 2 && !strcmp(path + len - 2, ".h");
+    FILE *out = fopen(path, header ? "w" : "wb");
+    if (out == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    if (header)
+    {
+        fprintf(out, "// %s, %dx%d, converted by convert_image from %s\n\n", name, width, height, argv[i]);
+        fprintf(out, "#define %s_width %d\n#define %s_height %d\n\n", name, width, name, height);
+        fprintf(out, "const unsigned char %s[%d] = {\n", name, width * height);
+    }
+
+    uint8_t rgb[DITHER_MAX_WIDTH * 3];
+    uint8_t row[DITHER_MAX_WIDTH];
+    for (int y = 0; y < height; y++)
+    {
+        if (fread(rgb, 3, width, in) != (size_t)width)
+        {
+            fprintf(stderr, "%s: truncated at row %d\n", argv[i], y);
+            return 1;
+        }
+        dither_row(&d, rgb, row);
+        if (header)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                fprintf(out, "%s0x%02x,%s", x % 16 ? "" : "    ", row[x], x % 16 == 15 || x == width - 1 ? "\n" : " ");
+            }
+        }
+        else
+        {
+            fwrite(row, 1, width, out);
+        }
+    }
+    if (header)
+    {
+        fprintf(out, "};\n");
+    }
+    fclose(out);
+    fclose(in);
+    return 0;
+}